@@ -4,10 +4,12 @@ set -e
 CC=clang
 STD="-std=c17"
 FLAGS="-Wall -Wextra -Wpedantic"
-LIBS=" -lpthread"
+LIBS=" -lpthread -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc"
 
 SRCS=(
     src/main.c
+    src/alloc.c
+    src/scenario.c
     src/tui/terminal.c
     src/tui/screen.c
     src/input/input.c
@@ -0,0 +1,41 @@
+#include "alloc.h"
+#include <stdatomic.h>
+
+static atomic_uint_fast64_t g_count;
+static atomic_uint_fast64_t g_bytes;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t n, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+
+static void count(size_t size) {
+    atomic_fetch_add_explicit(&g_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&g_bytes, size, memory_order_relaxed);
+}
+
+void *__wrap_malloc(size_t size) {
+    count(size);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+    count(n * size);
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    count(size);
+    return __real_realloc(ptr, size);
+}
+
+u64 alloc_count(void) {
+    return atomic_load_explicit(&g_count, memory_order_relaxed);
+}
+
+u64 alloc_bytes(void) {
+    return atomic_load_explicit(&g_bytes, memory_order_relaxed);
+}
@@ -0,0 +1,16 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include "common.h"
+
+// Heap allocation counter for the benchmark modes. The build links with
+// -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc so every call in the
+// program passes through alloc.c first.
+
+// malloc, calloc and realloc calls so far
+u64 alloc_count(void);
+
+// Bytes requested by those calls
+u64 alloc_bytes(void);
+
+#endif // ALLOC_H
@@ -37,3 +37,43 @@ void entity_draw(Entity *e, Screen *s, int x, int y) {
     screen_putc(s, x, y, e->shape);
     screen_set_fg_color(s, x, y, fg);
 }
+
+u64 entity_state_hash(const Entity *e) {
+    u64 h = STATE_HASH_SEED;
+    h = state_hash_add(h, e->type);
+    h = state_hash_add(h, e->x);
+    h = state_hash_add(h, e->y);
+    h = state_hash_add(h, e->alive);
+    h = state_hash_add(h, e->color);
+    h = state_hash_add(h, e->shape ? (unsigned char)e->shape[0] : 0);
+
+    switch (e->type) {
+    case ENTITY_PLAYER: {
+        const Player *p = (const Player *)e->ctx;
+        h = state_hash_add(h, p->health);
+        h = state_hash_add(h, p->damage);
+        h = state_hash_add(h, p->cooldown);
+        h = state_hash_add(h, p->ticks);
+        h = state_hash_add(h, p->damaged);
+        break;
+    }
+    case ENTITY_ENEMY: {
+        const Enemy *p = (const Enemy *)e->ctx;
+        h = state_hash_add(h, p->health);
+        h = state_hash_add(h, p->score);
+        h = state_hash_add(h, p->fire_freq);
+        h = state_hash_add(h, p->last_fired);
+        h = state_hash_add(h, p->damage);
+        break;
+    }
+    case ENTITY_BULLET: {
+        const Bullet *b = (const Bullet *)e->ctx;
+        h = state_hash_add(h, b->owner);
+        h = state_hash_add(h, b->damage);
+        h = state_hash_add(h, b->move_freq);
+        h = state_hash_add(h, b->last_moved);
+        break;
+    }
+    }
+    return h;
+}
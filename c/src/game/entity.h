@@ -49,6 +49,21 @@ bool entity_collision(const Entity *e1, const Entity *e2);
 // Draw entity at screen position
 void entity_draw(Entity *e, Screen *s, int x, int y);
 
+// State hashing, shared with the C++ version: values are folded one at a
+// time through the splitmix64 finalizer, so both produce the same hash for
+// the same state
+#define STATE_HASH_SEED 0xcbf29ce484222325ULL
+
+static inline u64 state_hash_add(u64 h, i64 v) {
+    u64 x = (h ^ (u64)v) + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Hash of the entity's position, state and its Player/Enemy/Bullet context
+u64 entity_state_hash(const Entity *e);
+
 typedef struct Player {
     int health;
     int damage;
@@ -317,6 +317,36 @@ void game_process_input(Game *g, Event *ev) {
     }
 }
 
+u64 game_state_hash(const Game *g) {
+    u64 h = STATE_HASH_SEED;
+    h = state_hash_add(h, g->bounds.w);
+    h = state_hash_add(h, g->bounds.h);
+    h = state_hash_add(h, g->level);
+    h = state_hash_add(h, g->score);
+    h = state_hash_add(h, g->status);
+    h = state_hash_add(h, g->shots_fired);
+    h = state_hash_add(h, g->shots_hit);
+    h = state_hash_add(h, g->kills);
+    h = state_hash_add(h, g->elapsed_time);
+    h = state_hash_add(h, (i64)entity_state_hash(&g->player));
+
+    u64 enemies = 0;
+    for (int i = 0; i < g->enemies.count; i++) {
+        enemies += entity_state_hash(&g->enemies.items[i]);
+    }
+    h = state_hash_add(h, g->enemies.count);
+    h = state_hash_add(h, (i64)enemies);
+
+    u64 bullets = 0;
+    for (int i = 0; i < g->bullets.count; i++) {
+        bullets += entity_state_hash(&g->bullets.items[i]);
+    }
+    h = state_hash_add(h, g->bullets.count);
+    h = state_hash_add(h, (i64)bullets);
+
+    return h;
+}
+
 // Cell draw callback for entities
 static void draw_entity_cell(void *ctx, Screen *s, int x, int y) {
     Entity *e = (Entity *)ctx;
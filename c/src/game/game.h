@@ -67,6 +67,11 @@ void game_remove_dead_entities(Game *g);
 // Process input event
 void game_process_input(Game *g, Event *ev);
 
+// Hash of the simulation state: player, enemies, bullets, score, level,
+// status and statistics. Enemies and bullets are summed, so their order in
+// the lists does not matter. Matches game::Game::stateHash() in C++.
+u64 game_state_hash(const Game *g);
+
 // Draw game (as frame item callback)
 void game_draw(void *ctx, Screen *s, BBox b);
 
@@ -3,13 +3,16 @@
 #endif
 
 #include <pthread.h>
+#include <sys/resource.h>
 #include <time.h>
 #include <unistd.h>
 
+#include "alloc.h"
 #include "common.h"
 #include "game/game.h"
 #include "game/level.h"
 #include "input/input.h"
+#include "scenario.h"
 #include "tui/screen.h"
 #include "ui/frame.h"
 #include "ui/menu.h"
@@ -155,7 +158,8 @@ static void *event_loop(void *ctx) {
     return NULL;
 }
 
-static void app_render(App *app) {
+// Draws the current screen into the back buffer
+static void app_draw(App *app) {
     screen_clear(app->screen);
 
     switch (app->current_screen) {
@@ -172,17 +176,221 @@ static void app_render(App *app) {
         menu_draw(&app->win_menu, app->screen);
         break;
     }
+}
 
+static void app_render(App *app) {
+    app_draw(app);
     screen_flush(app->screen);
 }
 
-int main(void) {
+// One game tick: update, level progression and the end-of-game screens
+static void app_tick(App *app, i64 udt) {
+    if (app->game.status != GAME_STATUS_RUNNING)
+        return;
+
+    game_update(&app->game, udt);
+    game_remove_dead_entities(&app->game);
+
+    // Check level completion
+    if (app->game.enemies.count == 0 && app->game.player.alive) {
+        app->game.level++;
+        if (app->game.level > LEVEL_COUNT) {
+            app->game.status = GAME_STATUS_FINISHED;
+            app->current_screen = SCREEN_WIN;
+        } else {
+            level_spawn(&app->game, &LEVELS[app->game.level - 1]);
+        }
+    }
+
+    if (app->game.status == GAME_STATUS_GAME_OVER) {
+        app->current_screen = SCREEN_GAME_OVER;
+    }
+}
+
+// Real-time loop: input thread plus one tick per game period, until quit
+static void app_run(App *app) {
+    // Initial render
+    app_render(app);
+
+    // Start input thread
+    pthread_t input_thread;
+    pthread_create(&input_thread, NULL, event_loop, app);
+
+    i64 sleep_time = US_PER_SEC / app->game.tps;
+
+    while (app->running) {
+        pthread_mutex_lock(&app->mutex);
+        app_tick(app, sleep_time);
+        app_render(app);
+        pthread_mutex_unlock(&app->mutex);
+
+        struct timespec ts;
+        ts.tv_sec = (time_t)(sleep_time / US_PER_SEC);
+        ts.tv_nsec = (long)((sleep_time % US_PER_SEC) * 1000LL);
+        nanosleep(&ts, NULL);
+    }
+
+    app->running = false;
+    pthread_join(input_thread, NULL);
+}
+
+#define SCENARIO_MAX_EVENTS 16
+
+static i64 now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (i64)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int cmp_i64(const void *a, const void *b) {
+    i64 x = *(const i64 *)a, y = *(const i64 *)b;
+    return (x > y) - (x < y);
+}
+
+// p-th percentile of the ns samples in microseconds; sorts them
+static double percentile_us(i64 *samples, int count, double p) {
+    if (count == 0) return 0;
+    qsort(samples, count, sizeof(*samples), cmp_i64);
+    return samples[(usize)(p * (count - 1))] / 1000.0;
+}
+
+// Writes one game_state_hash() per line: the state after setup, then the
+// state after every tick. check-trace.sh compares two of these.
+static bool write_trace(const char *path, const u64 *hashes, int count) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        fprintf(f, "%016llx\n", (unsigned long long)hashes[i]);
+    }
+    return fclose(f) == 0;
+}
+
+// Headless run of a scenario file (game-c --scenario <file>). Prints the
+// same JSON metrics as game-cpp --scenario so compare.sh can put them side
+// by side, and with a trace path also writes the state hash trace.
+static bool app_run_scenario(App *app, const Scenario *scn, const char *trace_path) {
+    app->game.level = scn->level;
+    if (scn->level > 1) {
+        for (int i = 0; i < app->game.enemies.count; i++) {
+            free(app->game.enemies.items[i].ctx);
+        }
+        app->game.enemies.count = 0;
+        level_spawn(&app->game, &LEVELS[scn->level - 1]);
+    }
+    if (scn->health > 0) {
+        ((Player *)app->game.player.ctx)->health = scn->health;
+    }
+
+    Vec(i64) tick_ns = {0};
+    Vec(i64) flush_ns = {0};
+    list_reserve(&tick_ns, scn->ticks);
+    list_reserve(&flush_ns, scn->ticks * (SCENARIO_MAX_EVENTS + 1));
+    Vec(u64) trace = {0};
+    list_reserve(&trace, scn->ticks + 1);
+    list_append(&trace, game_state_hash(&app->game));
+    Event events[SCENARIO_MAX_EVENTS];
+    u32 rng = scn->seed;
+
+    // The first frame draws everything; it is not part of the steady state
+    app_render(app);
+
+    u64 allocs_before = alloc_count();
+    u64 bytes_before = app->screen->bytes_written;
+    i64 udt = US_PER_SEC / app->game.tps;
+
+    // Like app_run(): a render after every event and every tick
+    int ticks = 0;
+    for (; ticks < scn->ticks && app->running; ticks++) {
+        int n = scenario_events(scn, ticks, &rng, events, SCENARIO_MAX_EVENTS);
+        if (n < 0) {
+            // Dropping the rest would make the trace diverge from game-cpp
+            fprintf(stderr, "%s: more than %d events on tick %d\n",
+                    scn->name, SCENARIO_MAX_EVENTS, ticks);
+            list_free(tick_ns);
+            list_free(flush_ns);
+            list_free(trace);
+            return false;
+        }
+        for (int i = 0; i < n; i++) {
+            process_input(app, &events[i]);
+            app_draw(app);
+            i64 t0 = now_ns();
+            screen_flush(app->screen);
+            list_append(&flush_ns, now_ns() - t0);
+        }
+
+        i64 t0 = now_ns();
+        app_tick(app, udt);
+        list_append(&tick_ns, now_ns() - t0);
+        list_append(&trace, game_state_hash(&app->game));
+
+        app_draw(app);
+        t0 = now_ns();
+        screen_flush(app->screen);
+        list_append(&flush_ns, now_ns() - t0);
+    }
+
+    u64 allocs = alloc_count() - allocs_before;
+    u64 bytes = app->screen->bytes_written - bytes_before;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    printf("{\n");
+    printf("  \"lang\": \"c\",\n");
+    printf("  \"scenario\": \"%s\",\n", scn->name);
+    printf("  \"ticks\": %d,\n", ticks);
+    printf("  \"frames\": %d,\n", flush_ns.count);
+    printf("  \"tick_p50_us\": %.3f,\n", percentile_us(tick_ns.items, tick_ns.count, 0.50));
+    printf("  \"tick_p99_us\": %.3f,\n", percentile_us(tick_ns.items, tick_ns.count, 0.99));
+    printf("  \"tick_max_us\": %.3f,\n", percentile_us(tick_ns.items, tick_ns.count, 1.0));
+    printf("  \"flush_p50_us\": %.3f,\n", percentile_us(flush_ns.items, flush_ns.count, 0.50));
+    printf("  \"flush_p99_us\": %.3f,\n", percentile_us(flush_ns.items, flush_ns.count, 0.99));
+    printf("  \"flush_max_us\": %.3f,\n", percentile_us(flush_ns.items, flush_ns.count, 1.0));
+    printf("  \"bytes_written\": %llu,\n", (unsigned long long)bytes);
+    printf("  \"max_rss_kb\": %ld,\n", usage.ru_maxrss);
+    printf("  \"allocations\": %llu\n", (unsigned long long)allocs);
+    printf("}\n");
+
+    bool ok = !trace_path || write_trace(trace_path, trace.items, trace.count);
+
+    list_free(tick_ns);
+    list_free(flush_ns);
+    list_free(trace);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    const char *scenario_path = NULL;
+    const char *trace_path = NULL;
+    if ((argc == 3 || argc == 5) && strcmp(argv[1], "--scenario") == 0) {
+        scenario_path = argv[2];
+        if (argc == 5) {
+            if (strcmp(argv[3], "--trace") != 0) scenario_path = NULL;
+            trace_path = argv[4];
+        }
+    }
+    if (argc != 1 && !scenario_path) {
+        fprintf(stderr, "usage: %s [--scenario <file> [--trace <file>]]\n", argv[0]);
+        return 2;
+    }
+
+    Scenario scenario = {0};
+    if (scenario_path && !scenario_load(&scenario, scenario_path)) {
+        return 2;
+    }
+
     App app = {0};
     app.running = true;
     app.current_screen = SCREEN_GAME;
     pthread_mutex_init(&app.mutex, NULL);
 
-    app.screen = screen_new();
+    app.screen = scenario_path
+                     ? screen_new_headless(scenario.width, scenario.height)
+                     : screen_new();
     if (!app.screen) {
         fprintf(stderr, "Failed to initialize screen\n");
         return 1;
@@ -311,50 +519,14 @@ int main(void) {
 
     frame_add_widget(split2[1], panel_as_widget(&stats));
 
-    // Initial render
-    app_render(&app);
-
-    // Start input thread
-    pthread_t input_thread;
-    pthread_create(&input_thread, NULL, event_loop, &app);
-
-    i64 sleep_time = US_PER_SEC / app.game.tps;
-
-    while (app.running) {
-        pthread_mutex_lock(&app.mutex);
-
-        if (app.game.status == GAME_STATUS_RUNNING) {
-            game_update(&app.game, sleep_time);
-            game_remove_dead_entities(&app.game);
-
-            // Check level completion
-            if (app.game.enemies.count == 0 && app.game.player.alive) {
-                app.game.level++;
-                if (app.game.level > LEVEL_COUNT) {
-                    app.game.status = GAME_STATUS_FINISHED;
-                    app.current_screen = SCREEN_WIN;
-                } else {
-                    level_spawn(&app.game, &LEVELS[app.game.level - 1]);
-                }
-            }
-
-            if (app.game.status == GAME_STATUS_GAME_OVER) {
-                app.current_screen = SCREEN_GAME_OVER;
-            }
-        }
-
-        app_render(&app);
-        pthread_mutex_unlock(&app.mutex);
-
-        struct timespec ts;
-        ts.tv_sec = (time_t)(sleep_time / US_PER_SEC);
-        ts.tv_nsec = (long)((sleep_time % US_PER_SEC) * 1000LL);
-        nanosleep(&ts, NULL);
+    int status = 0;
+    if (scenario_path) {
+        if (!app_run_scenario(&app, &scenario, trace_path)) status = 1;
+        scenario_free(&scenario);
+    } else {
+        app_run(&app);
     }
 
-    app.running = false;
-    pthread_join(input_thread, NULL);
-
     frame_free(app.frame);
     menu_free(&app.menu);
     menu_free(&app.game_over_menu);
@@ -362,5 +534,5 @@ int main(void) {
     screen_free(app.screen);
     pthread_mutex_destroy(&app.mutex);
 
-    return 0;
+    return status;
 }
@@ -0,0 +1,173 @@
+#include "scenario.h"
+#include "game/level.h"
+#include <stdio.h>
+#include <string.h>
+
+static bool parse_key(const char *name, KeyCode *key) {
+    static const struct {
+        const char *name;
+        KeyCode key;
+    } named[] = {
+        {"none", KEY_NONE},
+        {"space", (KeyCode)' '},
+        {"enter", KEY_ENTER},
+        {"esc", KEY_ESCAPE},
+        {"up", KEY_UP},
+        {"down", KEY_DOWN},
+        {"left", KEY_LEFT},
+        {"right", KEY_RIGHT},
+    };
+
+    for (usize i = 0; i < ARRAY_LEN(named); i++) {
+        if (strcmp(name, named[i].name) == 0) {
+            *key = named[i].key;
+            return true;
+        }
+    }
+
+    if (strlen(name) == 1 && name[0] > ' ' && name[0] < 0x7F) {
+        *key = (KeyCode)name[0];
+        return true;
+    }
+    return false;
+}
+
+static void set_name(Scenario *scn, const char *path) {
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+
+    usize len = strcspn(base, ".");
+    if (len >= sizeof(scn->name)) len = sizeof(scn->name) - 1;
+    memcpy(scn->name, base, len);
+    scn->name[len] = '\0';
+}
+
+static bool parse_line(Scenario *scn, char *line) {
+    char *words[34];
+    int count = 0;
+    for (char *w = strtok(line, " \t\r\n"); w && count < (int)ARRAY_LEN(words);
+         w = strtok(NULL, " \t\r\n")) {
+        if (w[0] == '#') break;
+        words[count++] = w;
+    }
+    if (count == 0) return true;
+
+    const char *cmd = words[0];
+    if (strcmp(cmd, "seed") == 0 && count == 2) {
+        scn->seed = (u32)strtoul(words[1], NULL, 10);
+    } else if (strcmp(cmd, "ticks") == 0 && count == 2) {
+        scn->ticks = atoi(words[1]);
+    } else if (strcmp(cmd, "size") == 0 && count == 2) {
+        return sscanf(words[1], "%dx%d", &scn->width, &scn->height) == 2;
+    } else if (strcmp(cmd, "level") == 0 && count == 2) {
+        scn->level = atoi(words[1]);
+    } else if (strcmp(cmd, "health") == 0 && count == 2) {
+        scn->health = atoi(words[1]);
+    } else if (strcmp(cmd, "key") == 0 && count == 3) {
+        ScenarioKey k = {.period = 0, .offset = atoi(words[1])};
+        if (!parse_key(words[2], &k.key)) return false;
+        list_append(&scn->keys, k);
+    } else if (strcmp(cmd, "repeat") == 0 && count == 4) {
+        ScenarioKey k = {.period = atoi(words[1]), .offset = atoi(words[2])};
+        if (k.period <= 0 || !parse_key(words[3], &k.key)) return false;
+        list_append(&scn->keys, k);
+    } else if (strcmp(cmd, "random") == 0 && count >= 3) {
+        scn->random_period = atoi(words[1]);
+        if (scn->random_period <= 0) return false;
+        scn->random_keys.count = 0;
+        for (int i = 2; i < count; i++) {
+            KeyCode key;
+            if (!parse_key(words[i], &key)) return false;
+            list_append(&scn->random_keys, key);
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool scenario_load(Scenario *scn, const char *path) {
+    *scn = (Scenario){
+        .seed = 1,
+        .ticks = 1000,
+        .width = 120,
+        .height = 40,
+        .level = 1,
+    };
+    set_name(scn, path);
+
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    char line[512];
+    int line_no = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f)) {
+        line_no++;
+        if (!parse_line(scn, line)) {
+            fprintf(stderr, "%s:%d: invalid directive\n", path, line_no);
+            ok = false;
+        }
+    }
+    fclose(f);
+
+    if (ok && (scn->ticks <= 0 || scn->width <= 0 || scn->height <= 0 ||
+               scn->level < 1 || scn->level > LEVEL_COUNT)) {
+        fprintf(stderr, "%s: ticks, size or level out of range\n", path);
+        ok = false;
+    }
+    if (!ok) scenario_free(scn);
+    return ok;
+}
+
+void scenario_free(Scenario *scn) {
+    list_free(scn->keys);
+    list_free(scn->random_keys);
+    scn->keys.items = NULL;
+    scn->keys.count = scn->keys.capacity = 0;
+    scn->random_keys.items = NULL;
+    scn->random_keys.count = scn->random_keys.capacity = 0;
+}
+
+u32 scenario_rand(u32 *state) {
+    u32 x = *state ? *state : 1;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static bool push_key(Event *events, int *count, int max, KeyCode key) {
+    if (key == KEY_NONE) return true;
+    if (*count >= max) return false;
+
+    Event ev = {.type = EVENT_KEY};
+    ev.key.key = key;
+    ev.key.mods = MOD_NONE;
+    if ((int)key < 0x7F) ev.key.ch[0] = (char)key;
+    events[(*count)++] = ev;
+    return true;
+}
+
+int scenario_events(const Scenario *scn, int tick, u32 *rng, Event *events, int max) {
+    int count = 0;
+
+    for (int i = 0; i < scn->keys.count; i++) {
+        const ScenarioKey *k = &scn->keys.items[i];
+        bool due = k->period ? tick % k->period == k->offset : tick == k->offset;
+        if (due && !push_key(events, &count, max, k->key)) return -1;
+    }
+
+    if (scn->random_period > 0 && scn->random_keys.count > 0 &&
+        tick % scn->random_period == 0) {
+        u32 r = scenario_rand(rng);
+        if (!push_key(events, &count, max, scn->random_keys.items[r % scn->random_keys.count])) {
+            return -1;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,54 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include "common.h"
+#include "input/input.h"
+
+// Headless run description shared with the C++ version (scenarios/*.txt).
+// One directive per line, '#' starts a comment:
+//   seed <n>                 generator seed for `random`
+//   ticks <n>                game ticks to run
+//   size <w>x<h>             screen size in cells
+//   level <n>                starting level
+//   health <n>               player health at the start
+//   key <tick> <key>         one key event before that tick
+//   repeat <period> <offset> <key>
+//                            a key event before every tick t with
+//                            t % period == offset
+//   random <period> <key>... before every period-th tick, one key picked
+//                            by the seeded generator
+// Keys are single characters or one of space, enter, esc, up, down, left,
+// right; `none` sends nothing.
+
+typedef struct ScenarioKey {
+    int period;  // 0: only at tick `offset`
+    int offset;
+    KeyCode key;
+} ScenarioKey;
+
+typedef struct Scenario {
+    char name[64];  // file name without directory and extension
+    u32 seed;
+    int ticks;
+    int width, height;
+    int level;
+    int health;     // 0 keeps the default
+    Vec(ScenarioKey) keys;
+    int random_period;
+    Vec(KeyCode) random_keys;
+} Scenario;
+
+// Parses the scenario file at path; prints the problem and returns false
+// on errors
+bool scenario_load(Scenario *scn, const char *path);
+
+void scenario_free(Scenario *scn);
+
+// Next value of the xorshift32 generator both versions use
+u32 scenario_rand(u32 *state);
+
+// Writes the key events for tick t into events and returns how many there
+// are, or -1 if there are more than max
+int scenario_events(const Scenario *scn, int tick, u32 *rng, Event *events, int max);
+
+#endif // SCENARIO_H
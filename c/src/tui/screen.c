@@ -4,11 +4,12 @@
 #include <string.h>
 #include <unistd.h>
 
-Screen *screen_new(void) {
-    Screen *s = malloc(sizeof(Screen));
+static Screen *screen_alloc(int width, int height) {
+    Screen *s = calloc(1, sizeof(Screen));
     if (!s) return NULL;
 
-    terminal_get_size(&s->width, &s->height);
+    s->width = width;
+    s->height = height;
 
     int size = s->width * s->height;
     s->back = malloc(size * sizeof(Cell));
@@ -26,15 +27,34 @@ Screen *screen_new(void) {
         cell_init(&s->front[i]);
     }
 
+    return s;
+}
+
+Screen *screen_new(void) {
+    int width, height;
+    terminal_get_size(&width, &height);
+
+    Screen *s = screen_alloc(width, height);
+    if (!s) return NULL;
+
     terminal_setup(&s->terminal);
 
     return s;
 }
 
+Screen *screen_new_headless(int width, int height) {
+    Screen *s = screen_alloc(width, height);
+    if (!s) return NULL;
+
+    s->headless = true;
+
+    return s;
+}
+
 void screen_free(Screen *s) {
     if (!s) return;
 
-    terminal_restore(&s->terminal);
+    if (!s->headless) terminal_restore(&s->terminal);
 
     free(s->back);
     free(s->front);
@@ -42,6 +62,8 @@ void screen_free(Screen *s) {
 }
 
 void screen_resize(Screen *s) {
+    if (s->headless) return;
+
     int new_w, new_h;
     terminal_get_size(&new_w, &new_h);
 
@@ -200,6 +222,11 @@ void screen_fill_color(Screen *s, int x, int y, int w, int h,
     }
 }
 
+static void screen_write(Screen *s, const char *buf, int len) {
+    s->bytes_written += (uint64_t)len;
+    if (!s->headless) write(STDOUT_FILENO, buf, len);
+}
+
 void screen_flush(Screen *s) {
     static char buf[65536];
     int buf_pos = 0;
@@ -230,7 +257,7 @@ void screen_flush(Screen *s) {
             }
 
             if (buf_pos > (int)sizeof(buf) - 256) {
-                write(STDOUT_FILENO, buf, buf_pos);
+                screen_write(s, buf, buf_pos);
                 buf_pos = 0;
             }
 
@@ -290,7 +317,7 @@ void screen_flush(Screen *s) {
     }
 
     if (buf_pos > 0) {
-        write(STDOUT_FILENO, buf, buf_pos);
+        screen_write(s, buf, buf_pos);
     }
 
     #undef BUF_APPEND
@@ -303,6 +330,6 @@ void screen_flush_full(Screen *s) {
         s->front[i].ch[0] = '\0';
     }
 
-    printf(ESC_CLEAR_SCREEN);
+    if (!s->headless) printf(ESC_CLEAR_SCREEN);
     screen_flush(s);
 }
@@ -10,11 +10,16 @@ typedef struct Screen {
     int width;
     int height;
     Terminal terminal;    // terminal state
+    bool headless;        // no terminal: flushes are counted, not written
+    uint64_t bytes_written; // bytes produced by flushes so far
 } Screen;
 
 // Create new screen (allocates buffers, enters raw mode)
 Screen *screen_new(void);
 
+// Create a w x h screen that never touches the terminal (benchmarks)
+Screen *screen_new_headless(int width, int height);
+
 // Free screen (restores terminal, frees buffers)
 void screen_free(Screen *s);
 
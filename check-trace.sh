@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+# Compares two game state traces (game-c/game-cpp --scenario <file> --trace
+# <out>) and reports the first tick where they differ. Line 1 of a trace is
+# the state after setup (tick 0), line n+1 the state after tick n.
+
+usage() {
+    echo "Uporaba: $0 <sled-a> <sled-b>"
+    echo "         $0 <scenarij>"
+    echo ""
+    echo "S scenarijem zažene C in C++ verzijo in primerja njuni sledi."
+    exit 1
+}
+
+# compare <trace-a> <trace-b>
+compare() {
+    local ticks_a ticks_b
+    ticks_a=$(wc -l < "$1")
+    ticks_b=$(wc -l < "$2")
+
+    local first
+    first=$(paste -d ' ' "$1" "$2" | awk '$1 != $2 { print NR - 1; exit }')
+
+    if [ -z "$first" ]; then
+        echo "Sledi se ujemata ($ticks_a stanj)."
+        return 0
+    fi
+
+    echo "Sledi se razlikujeta od tika $first naprej."
+    echo "  $1: $(sed -n "$((first + 1))p" "$1")"
+    echo "  $2: $(sed -n "$((first + 1))p" "$2")"
+    if [ "$ticks_a" -ne "$ticks_b" ]; then
+        echo "  dolžini: $ticks_a in $ticks_b stanj"
+    fi
+    return 1
+}
+
+case $# in
+    1)
+        for bin in ./c/build/game-c ./cpp/build/game-cpp; do
+            if [ ! -f "$bin" ]; then
+                echo "$bin ni preveden (./build.sh c, ./build.sh cpp)."
+                exit 1
+            fi
+        done
+
+        dir="$(mktemp -d)"
+        trap 'rm -rf "$dir"' EXIT
+        ./c/build/game-c --scenario "$1" --trace "$dir/c.trace" > /dev/null || exit 1
+        ./cpp/build/game-cpp --scenario "$1" --trace "$dir/cpp.trace" > /dev/null || exit 1
+        cd "$dir" && compare c.trace cpp.trace
+        ;;
+    2)
+        compare "$1" "$2"
+        ;;
+    *)
+        usage
+        ;;
+esac
@@ -0,0 +1,76 @@
+#!/usr/bin/env bash
+# Runs the scenarios in scenarios/ headless in the C and C++ versions and
+# prints their metrics side by side.
+
+METRICS=(
+    ticks frames
+    tick_p50_us tick_p99_us tick_max_us
+    flush_p50_us flush_p99_us flush_max_us
+    bytes_written max_rss_kb allocations
+)
+
+check_and_build() {
+    if [ ! -f "./c/build/game-c" ]; then
+        echo "C verzija ni prevedena. Prevajam..."
+        "./build.sh" c
+        echo ""
+    fi
+    if [ ! -f "./cpp/build/game-cpp" ]; then
+        echo "C++ verzija ni prevedena. Prevajam..."
+        "./build.sh" cpp
+        echo ""
+    fi
+}
+
+# metric <json file> <key>: value of one key from the flat JSON
+metric() {
+    sed -n "s/^ *\"$2\": *\"\{0,1\}\([^\",]*\)\"\{0,1\},\{0,1\}$/\1/p" "$1"
+}
+
+compare() {
+    local file="$1"
+    local out_c out_cpp
+    out_c="$(mktemp)"
+    out_cpp="$(mktemp)"
+
+    if ! "./c/build/game-c" --scenario "$file" > "$out_c" ||
+       ! "./cpp/build/game-cpp" --scenario "$file" > "$out_cpp"; then
+        echo "Scenarij $file ni uspel."
+        rm -f "$out_c" "$out_cpp"
+        return 1
+    fi
+
+    echo "Scenarij: $(metric "$out_c" scenario)"
+    printf "  %-14s %14s %14s\n" "" "C" "C++"
+    for m in "${METRICS[@]}"; do
+        printf "  %-14s %14s %14s\n" "$m" "$(metric "$out_c" "$m")" "$(metric "$out_cpp" "$m")"
+    done
+    echo ""
+
+    rm -f "$out_c" "$out_cpp"
+}
+
+usage() {
+    echo "Uporaba: $0 [scenarij...]"
+    echo ""
+    echo "Brez argumentov zažene vse scenarije v scenarios/."
+    exit 1
+}
+
+case "$1" in
+    -h|--help)
+        usage
+        ;;
+esac
+
+check_and_build
+
+if [ $# -eq 0 ]; then
+    set -- scenarios/*.txt
+fi
+
+status=0
+for file in "$@"; do
+    compare "$file" || status=1
+done
+exit $status
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "common.hpp"
+#include <cstdio>
+
+namespace bench {
+
+// Keeps the optimizer from discarding a value computed by a benchmark
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Calls fn until at least minTimeUs have passed, returns ns per call
+template <typename F>
+double nsPerCall(F&& fn, i64 minTimeUs = 200'000) {
+    fn();  // warm up
+
+    i64 iters = 1;
+    for (;;) {
+        i64 start = time_us();
+        for (i64 i = 0; i < iters; i++) fn();
+        i64 elapsed = time_us() - start;
+
+        if (elapsed >= minTimeUs) {
+            return static_cast<double>(elapsed) * 1000.0 / static_cast<double>(iters);
+        }
+        iters *= 2;
+    }
+}
+
+// Like nsPerCall, but runs prepare() untimed before every call of fn
+template <typename P, typename F>
+double nsPerPreparedCall(P&& prepare, F&& fn, i64 minTimeUs = 200'000) {
+    using Clock = std::chrono::steady_clock;
+    prepare();
+    fn();  // warm up
+
+    i64 calls = 0;
+    Clock::duration timed{};
+    i64 start = time_us();
+    while (time_us() - start < minTimeUs) {
+        prepare();
+        auto t0 = Clock::now();
+        fn();
+        timed += Clock::now() - t0;
+        calls++;
+    }
+    return std::chrono::duration<double, std::nano>(timed).count() / static_cast<double>(calls);
+}
+
+// Stream the group tables are printed to: stdout, or stderr when stdout
+// carries the JSON report
+FILE* out();
+
+// Adds a result to the JSON report
+void record(const char* group, const std::string& name, double value, const char* unit);
+
+// Report mode and output, used by main()
+void setJson(bool json);
+void writeJson(FILE* f);
+
+// Benchmark groups, each defined in its own translation unit. They return
+// false when a tracked metric regressed past its recorded budget.
+bool runDiff();
+bool runSgr();
+bool runFlush();
+bool runScreen();
+bool runInput();
+bool runGame();
+bool runVt();
+
+// Decodes the frames of an asciicast file recorded with game-cpp --cast
+// and reports bytes per frame and frame intervals (bench-cpp --cast)
+bool runCast(const std::string& path);
+
+} // namespace bench
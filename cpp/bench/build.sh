@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+
+CXX=clang++
+STD="-std=c++17"
+FLAGS="-Wall -Wextra -Wpedantic"
+FLAGS="$FLAGS -Wno-unused-parameter"
+OPT_FLAGS="-O2"
+
+SRCS=(
+    bench/main.cpp
+    bench/diff_bench.cpp
+    bench/sgr_bench.cpp
+    bench/flush_bench.cpp
+    bench/screen_bench.cpp
+    bench/input_bench.cpp
+    bench/game_bench.cpp
+    bench/vt_bench.cpp
+    bench/cast_bench.cpp
+    bench/scene.cpp
+    bench/report.cpp
+    bench/vt.cpp
+    bench/legacy_input.cpp
+    src/tui/terminal.cpp
+    src/tui/screen.cpp
+    src/tui/diff.cpp
+    src/tui/glyph.cpp
+    src/tui/style.cpp
+    src/tui/sgr.cpp
+    src/tui/encoder.cpp
+    src/tui/output.cpp
+    src/tui/writer.cpp
+    src/tui/backend.cpp
+    src/input/input.cpp
+    src/ui/frame.cpp
+    src/ui/grid.cpp
+    src/ui/menu.cpp
+    src/ui/panel.cpp
+    src/game/entity.cpp
+    src/game/game.cpp
+    src/game/level.cpp
+)
+
+cd "$(dirname "$0")/.."
+
+mkdir -p build
+$CXX $STD $FLAGS $OPT_FLAGS -I src -I bench "${SRCS[@]}" -o build/bench-cpp "$@"
@@ -0,0 +1,239 @@
+#include "bench.hpp"
+#include "vt.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+
+namespace bench {
+
+namespace {
+
+// Output events of an asciicast v2 file, as game-cpp --cast writes them
+struct Cast {
+    int width = 0;
+    int height = 0;
+
+    struct Frame {
+        double time;  // seconds since the recording started
+        std::string data;
+    };
+    std::vector<Frame> frames;
+};
+
+// Minimal JSON reading for the lines of a cast file: numbers and strings,
+// positioned by the caller
+class LineReader {
+public:
+    LineReader(const std::string& line, const std::string& where)
+        : m_line(line), m_where(where) {}
+
+    void skipSpace() {
+        while (m_pos < m_line.size() && (m_line[m_pos] == ' ' || m_line[m_pos] == '\t')) m_pos++;
+    }
+
+    void expect(char c) {
+        skipSpace();
+        if (m_pos >= m_line.size() || m_line[m_pos] != c) fail(std::string("expected '") + c + "'");
+        m_pos++;
+    }
+
+    double number() {
+        skipSpace();
+        const char* begin = m_line.c_str() + m_pos;
+        char* end = nullptr;
+        double v = std::strtod(begin, &end);
+        if (end == begin) fail("expected a number");
+        m_pos += static_cast<size_t>(end - begin);
+        return v;
+    }
+
+    std::string string() {
+        expect('"');
+        std::string s;
+        while (m_pos < m_line.size() && m_line[m_pos] != '"') {
+            char c = m_line[m_pos++];
+            if (c != '\\') {
+                s += c;
+                continue;
+            }
+            if (m_pos >= m_line.size()) break;
+            switch (char e = m_line[m_pos++]) {
+            case 'n': s += '\n'; break;
+            case 'r': s += '\r'; break;
+            case 't': s += '\t'; break;
+            case 'b': s += '\b'; break;
+            case 'f': s += '\f'; break;
+            case 'u': appendUtf8(s, codePoint()); break;
+            default:  s += e; break;  // " \ /
+            }
+        }
+        expect('"');
+        return s;
+    }
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error(m_where + ": " + what + " at column " + std::to_string(m_pos + 1));
+    }
+
+private:
+    u32 hex4() {
+        if (m_pos + 4 > m_line.size()) fail("truncated \\u escape");
+        u32 v = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = m_line[m_pos++];
+            v <<= 4;
+            if (c >= '0' && c <= '9') v |= static_cast<u32>(c - '0');
+            else if (c >= 'a' && c <= 'f') v |= static_cast<u32>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') v |= static_cast<u32>(c - 'A' + 10);
+            else fail("bad \\u escape");
+        }
+        return v;
+    }
+
+    // After "\u": one code point, joining a UTF-16 surrogate pair
+    u32 codePoint() {
+        u32 cp = hex4();
+        if (cp >= 0xD800 && cp < 0xDC00 && m_line.compare(m_pos, 2, "\\u") == 0) {
+            m_pos += 2;
+            u32 low = hex4();
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        }
+        return cp;
+    }
+
+    static void appendUtf8(std::string& s, u32 cp) {
+        if (cp < 0x80) {
+            s += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            s += static_cast<char>(0xC0 | (cp >> 6));
+            s += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            s += static_cast<char>(0xE0 | (cp >> 12));
+            s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            s += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            s += static_cast<char>(0xF0 | (cp >> 18));
+            s += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            s += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    const std::string& m_line;
+    const std::string& m_where;
+    size_t m_pos = 0;
+};
+
+// Value of "key": N in the header object
+int headerInt(const std::string& header, const char* key, const std::string& path) {
+    std::string quoted = std::string("\"") + key + "\"";
+    size_t at = header.find(quoted);
+    if (at == std::string::npos) throw std::runtime_error(path + ": header has no " + key);
+    size_t colon = header.find(':', at + quoted.size());
+    if (colon == std::string::npos) throw std::runtime_error(path + ": bad header");
+    return std::atoi(header.c_str() + colon + 1);
+}
+
+// Throws std::runtime_error if the file is missing or malformed
+Cast loadCast(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error(path + ": cannot open");
+
+    std::string line;
+    if (!std::getline(in, line)) throw std::runtime_error(path + ": empty");
+    Cast cast;
+    cast.width = headerInt(line, "width", path);
+    cast.height = headerInt(line, "height", path);
+    if (cast.width <= 0 || cast.height <= 0) throw std::runtime_error(path + ": bad size");
+
+    // [time, "type", "data"]; only output ("o") events draw
+    for (int n = 2; std::getline(in, line); n++) {
+        if (line.empty()) continue;
+        LineReader r(line, path + ":" + std::to_string(n));
+        r.expect('[');
+        double time = r.number();
+        r.expect(',');
+        std::string type = r.string();
+        r.expect(',');
+        std::string data = r.string();
+        r.expect(']');
+        if (type == "o") cast.frames.push_back({time, std::move(data)});
+    }
+    return cast;
+}
+
+double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    return v[static_cast<size_t>(p * static_cast<double>(v.size() - 1))];
+}
+
+} // namespace
+
+bool runCast(const std::string& path) {
+    Cast cast;
+    try {
+        cast = loadCast(path);
+    } catch (const std::runtime_error& e) {
+        std::fprintf(out(), "%s\n", e.what());
+        return false;
+    }
+
+    VirtualTerminal vt(cast.width, cast.height);
+    std::vector<double> bytes, sequences, intervalsMs;
+    bytes.reserve(cast.frames.size());
+    sequences.reserve(cast.frames.size());
+    u64 unknown = 0;
+
+    for (size_t i = 0; i < cast.frames.size(); i++) {
+        vt.resetCounts();
+        vt.feed(cast.frames[i].data);
+        bytes.push_back(static_cast<double>(vt.counts().bytes));
+        sequences.push_back(static_cast<double>(vt.counts().sequences()));
+        unknown += vt.counts().unknown;
+        if (i > 0) intervalsMs.push_back((cast.frames[i].time - cast.frames[i - 1].time) * 1000.0);
+    }
+
+    double total = 0;
+    for (double b : bytes) total += b;
+    double frames = static_cast<double>(cast.frames.size());
+    double seconds = cast.frames.empty() ? 0 : cast.frames.back().time - cast.frames.front().time;
+
+    std::fprintf(out(), "Recorded session %s decoded by a virtual terminal (%dx%d)\n",
+                 path.c_str(), cast.width, cast.height);
+    std::fprintf(out(), "  frames %zu over %.1f s, %.0f bytes\n",
+                 cast.frames.size(), seconds, total);
+    std::fprintf(out(), "  %-16s %10s %10s %10s %10s\n", "per frame", "mean", "p50", "p99", "max");
+    std::fprintf(out(), "  %-16s %10.1f %10.1f %10.1f %10.1f\n", "bytes",
+                 frames ? total / frames : 0.0, percentile(bytes, 0.50), percentile(bytes, 0.99),
+                 percentile(bytes, 1.0));
+    double seqTotal = 0;
+    for (double s : sequences) seqTotal += s;
+    std::fprintf(out(), "  %-16s %10.1f %10.1f %10.1f %10.1f\n", "sequences",
+                 frames ? seqTotal / frames : 0.0, percentile(sequences, 0.50),
+                 percentile(sequences, 0.99), percentile(sequences, 1.0));
+    double intervalTotal = 0;
+    for (double t : intervalsMs) intervalTotal += t;
+    std::fprintf(out(), "  %-16s %10.1f %10.1f %10.1f %10.1f\n", "interval ms",
+                 intervalsMs.empty() ? 0.0 : intervalTotal / static_cast<double>(intervalsMs.size()),
+                 percentile(intervalsMs, 0.50), percentile(intervalsMs, 0.99),
+                 percentile(intervalsMs, 1.0));
+
+    record("cast", "bytes/frame", frames ? total / frames : 0.0, "bytes/frame");
+    record("cast", "bytes/frame p99", percentile(bytes, 0.99), "bytes/frame");
+    record("cast", "frame interval p50", percentile(intervalsMs, 0.50), "ms");
+    record("cast", "frame interval p99", percentile(intervalsMs, 0.99), "ms");
+
+    // The model covers everything the encoder emits; anything else means
+    // the capture was not made by game-cpp or the encoder changed
+    if (unknown > 0) {
+        std::fprintf(out(), "  %llu sequences the model does not handle\n",
+                     static_cast<unsigned long long>(unknown));
+        return false;
+    }
+    return true;
+}
+
+} // namespace bench
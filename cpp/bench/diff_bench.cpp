@@ -0,0 +1,79 @@
+#include "bench.hpp"
+#include "tui/diff.hpp"
+
+#include <cstdio>
+#include <random>
+
+namespace bench {
+
+namespace {
+
+struct Size {
+    int w, h;
+};
+
+// Back/front buffers of a headless w x h screen with random content
+struct Buffers {
+    std::vector<tui::Cell> back;
+    std::vector<tui::Cell> front;
+
+    Buffers(Size size, u32 seed) : back(size.w * size.h) {
+        std::mt19937 rng(seed);
+        for (auto& c : back) {
+            c.glyph = ' ' + rng() % 95;
+            c.style = static_cast<u16>(rng() % 16);
+        }
+        front = back;
+    }
+};
+
+// Diffs every row of the screen, as flush() does on a full-width damage
+double frameNs(const tui::DiffKernel& kernel, const Buffers& buf, Size size) {
+    return nsPerCall([&] {
+        int changed = 0;
+        for (int y = 0; y < size.h; y++) {
+            auto range = kernel.fn(&buf.back[y * size.w], &buf.front[y * size.w], size.w);
+            changed += range.empty() ? 0 : range.last - range.first + 1;
+        }
+        doNotOptimize(changed);
+    });
+}
+
+} // namespace
+
+bool runDiff() {
+    const Size sizes[] = {{80, 24}, {250, 70}, {1000, 300}};
+    const auto& kernels = tui::diffKernels();
+
+    std::fprintf(out(), "Screen diff (ns per frame, every row diffed)\n");
+    std::fprintf(out(), "%-10s %-8s %14s %14s %9s\n",
+                "size", "kernel", "unchanged", "1 cell/row", "speedup");
+
+    for (auto size : sizes) {
+        Buffers same(size, 1);
+        Buffers sparse(size, 1);
+        for (int y = 0; y < size.h; y++) {
+            sparse.back[y * size.w + size.w / 2].glyph = '#';
+            sparse.front[y * size.w + size.w / 2].glyph = '.';
+        }
+
+        double scalarNs = 0;
+        for (const auto& kernel : kernels) {
+            double sameNs = frameNs(kernel, same, size);
+            double sparseNs = frameNs(kernel, sparse, size);
+            if (scalarNs == 0) scalarNs = sameNs;
+
+            char label[16];
+            std::snprintf(label, sizeof(label), "%dx%d", size.w, size.h);
+            std::fprintf(out(), "%-10s %-8s %14.0f %14.0f %8.2fx\n",
+                        label, kernel.name, sameNs, sparseNs, scalarNs / sameNs);
+
+            std::string name = std::string(label) + " " + kernel.name;
+            record("diff", name + " unchanged", sameNs, "ns");
+            record("diff", name + " 1 cell/row", sparseNs, "ns");
+        }
+    }
+    return true;
+}
+
+} // namespace bench
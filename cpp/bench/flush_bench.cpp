@@ -0,0 +1,83 @@
+#include "bench.hpp"
+#include "scene.hpp"
+
+#include <cstdio>
+
+namespace bench {
+
+namespace {
+
+constexpr int FRAMES = 200;
+
+struct Bytes {
+    size_t first;     // initial full draw
+    double perFrame;  // average over the following frames
+    size_t menu;      // switch from the game to the menu
+    size_t redraw;    // game redrawn over an unknown terminal
+};
+
+Bytes measure(int w, int h, tui::EncoderOptions options) {
+    Scene scene(w, h);
+    tui::Encoder encoder = scene.makeEncoder(options);
+    tui::OutputBuffer out;
+
+    scene.draw(0);
+    Bytes bytes{scene.encode(encoder, out), 0, 0, 0};
+
+    size_t total = 0;
+    for (int n = 1; n <= FRAMES; n++) {
+        scene.draw(n);
+        total += scene.encode(encoder, out);
+    }
+    bytes.perFrame = static_cast<double>(total) / FRAMES;
+
+    scene.drawMenu();
+    bytes.menu = scene.encode(encoder, out);
+
+    scene.draw(FRAMES);
+    scene.invalidate();
+    bytes.redraw = scene.encode(encoder, out);
+    return bytes;
+}
+
+} // namespace
+
+bool runFlush() {
+    struct Size { int w, h; };
+    const Size sizes[] = {{80, 24}, {250, 70}};
+
+    std::fprintf(out(), "Flush output bytes (game scene, %d frames)\n", FRAMES);
+    std::fprintf(out(), "%-10s %-8s %10s %10s %10s %10s\n",
+                "size", "encoder", "full draw", "per frame", "menu", "redraw");
+
+    for (auto size : sizes) {
+        char label[16];
+        std::snprintf(label, sizeof(label), "%dx%d", size.w, size.h);
+
+        tui::EncoderOptions cup;
+        cup.relativeMoves = false;
+        cup.erase = false;
+        tui::EncoderOptions cost;
+        cost.erase = false;
+        tui::EncoderOptions runs;
+        runs.repeat = true;
+
+        struct Variant { const char* name; tui::EncoderOptions options; };
+        const Variant variants[] = {{"cup", cup}, {"cost", cost}, {"runs", runs}};
+
+        for (const auto& v : variants) {
+            Bytes b = measure(size.w, size.h, v.options);
+            std::fprintf(out(), "%-10s %-8s %10zu %10.1f %10zu %10zu\n",
+                        label, v.name, b.first, b.perFrame, b.menu, b.redraw);
+
+            std::string name = std::string(label) + " " + v.name;
+            record("flush", name + " full draw", b.first, "bytes");
+            record("flush", name + " per frame", b.perFrame, "bytes");
+            record("flush", name + " menu", b.menu, "bytes");
+            record("flush", name + " redraw", b.redraw, "bytes");
+        }
+    }
+    return true;
+}
+
+} // namespace bench
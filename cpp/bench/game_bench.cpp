@@ -0,0 +1,59 @@
+#include "bench.hpp"
+#include "game/game.hpp"
+#include "game/level.hpp"
+
+namespace bench {
+
+namespace {
+
+// Level 3 on the 11x11 field with a fresh set of bullets spread over it
+void populate(game::Game& g, int bullets) {
+    g.bullets().clear();
+    g.enemies().clear();
+    game::spawnLevel(g, game::LEVELS[2]);
+
+    for (int i = 0; i < bullets; i++) {
+        int x = (i * 7) % g.bounds().w;
+        int y = (i * 3) % g.bounds().h;
+        auto owner = (i % 2) ? game::EntityType::Enemy : game::EntityType::Player;
+        g.spawnBullet(x, y, 1, owner);
+    }
+}
+
+} // namespace
+
+bool runGame() {
+    const int counts[] = {100, 4000};
+
+    std::fprintf(out(), "Game (ns per call, level 3)\n");
+    std::fprintf(out(), "%-8s %-20s %12s\n", "bullets", "operation", "ns");
+
+    for (int count : counts) {
+        game::Game g(11, 11, 4);
+        g.spawnPlayer(5, 10, 1'000'000, 1, 2);
+
+        struct Op { const char* name; double ns; };
+        const Op ops[] = {
+            {"update", nsPerPreparedCall(
+                [&] { populate(g, count); },
+                [&] { g.update(250'000); })},
+            {"removeDeadEntities", nsPerPreparedCall(
+                [&] {
+                    populate(g, count);
+                    for (size_t i = 0; i < g.bullets().size(); i += 2) g.bullets()[i]->kill();
+                },
+                [&] { g.removeDeadEntities(); })},
+            {"placeEntitiesOnGrid", nsPerPreparedCall(
+                [&] {},
+                [&] { g.placeEntitiesOnGrid(); })},
+        };
+
+        for (const auto& op : ops) {
+            std::fprintf(out(), "%-8d %-20s %12.0f\n", count, op.name, op.ns);
+            record("game", std::to_string(count) + " bullets " + op.name, op.ns, "ns");
+        }
+    }
+    return true;
+}
+
+} // namespace bench
@@ -0,0 +1,168 @@
+#include "bench.hpp"
+#include "legacy_input.hpp"
+#include "input/input.hpp"
+#include "input/queue.hpp"
+
+#include <thread>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace bench {
+
+namespace {
+
+constexpr int STREAM_EVENTS = 20000;
+
+// Game keys with arrow keys mixed in, as a player holding keys sends them
+std::string keyStream() {
+    const char* keys[] = {"a", "d", " ", "\x1b[D", "\x1b[C", "m", "\x1b[B", "\r"};
+    std::string s;
+    for (int i = 0; i < STREAM_EVENTS; i++) s += keys[(i * 7) % 8];
+    return s;
+}
+
+// SGR mouse motion reports from sweeping the pointer over the screen
+std::string mouseStream() {
+    std::string s;
+    for (int i = 0; i < STREAM_EVENTS; i++) {
+        s += "\x1b[<35;" + std::to_string(1 + i % 250) + ";" + std::to_string(1 + (i / 250) % 70) + "M";
+    }
+    return s;
+}
+
+// Recorded input in a memory file, replayed from the start on every pass
+struct Recording {
+    int fd;
+    size_t size;
+
+    explicit Recording(const std::string& bytes) : size(bytes.size()) {
+        fd = memfd_create("bench-input", 0);
+        ssize_t written = write(fd, bytes.data(), bytes.size());
+        doNotOptimize(written);
+    }
+    ~Recording() { close(fd); }
+
+    Recording(const Recording&) = delete;
+    Recording& operator=(const Recording&) = delete;
+};
+
+bool drained(const Recording& rec) {
+    return static_cast<size_t>(lseek(rec.fd, 0, SEEK_CUR)) == rec.size;
+}
+
+enum class Api { Legacy, Poll, PollAll };
+
+const char* apiName(Api api) {
+    switch (api) {
+        case Api::Legacy: return "legacy";
+        case Api::Poll:   return "poll";
+        default:          return "pollAll";
+    }
+}
+
+// Decodes the whole recording with the old parser, with poll(), or with
+// pollAll() batches, returns the event count
+int decodeAll(Recording& rec, Api api) {
+    lseek(rec.fd, 0, SEEK_SET);
+
+    int events = 0;
+    if (api == Api::Legacy) {
+        LegacyInput legacy(rec.fd);
+        for (;;) {
+            if (legacy.poll()) {
+                events++;
+            } else if (drained(rec)) {
+                break;
+            }
+        }
+        return events;
+    }
+
+    input::InputHandler handler(rec.fd);
+    if (api == Api::PollAll) {
+        std::array<input::Event, 64> buf;
+        for (;;) {
+            size_t n = handler.pollAll(buf.data(), buf.size());
+            events += static_cast<int>(n);
+            if (n == 0 && drained(rec)) break;
+        }
+        return events;
+    }
+
+    for (;;) {
+        if (handler.poll()) {
+            events++;
+        } else if (drained(rec)) {
+            break;
+        }
+    }
+    return events;
+}
+
+// Events pushed by one thread and popped by another as fast as they can,
+// ns per event handed over. Both sides yield rather than spin, so this
+// also works on a single core.
+double queueHandoffNs() {
+    constexpr i64 EVENTS = 2'000'000;
+    static input::SpscQueue<input::TimedEvent, 1024> queue;
+
+    i64 start = time_us();
+    std::thread producer([] {
+        input::TimedEvent ev;
+        for (i64 i = 0; i < EVENTS; i++) {
+            ev.time = i;
+            while (!queue.push(ev)) std::this_thread::yield();
+        }
+    });
+
+    input::TimedEvent ev;
+    i64 sum = 0;
+    for (i64 received = 0; received < EVENTS;) {
+        if (queue.pop(ev)) {
+            sum += ev.time;
+            received++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    doNotOptimize(sum);
+    return static_cast<double>(time_us() - start) * 1000.0 / EVENTS;
+}
+
+} // namespace
+
+bool runInput() {
+    struct Stream { const char* name; std::string bytes; };
+    const Stream streams[] = {{"keys", keyStream()}, {"sgr mouse", mouseStream()}};
+
+    std::fprintf(out(), "InputHandler on recorded streams (legacy: the parser it replaced)\n");
+    std::fprintf(out(), "%-10s %-8s %10s %10s %12s %10s\n",
+                 "stream", "api", "bytes", "events", "ns/event", "MB/s");
+
+    for (const auto& stream : streams) {
+        Recording rec(stream.bytes);
+        for (Api api : {Api::Legacy, Api::Poll, Api::PollAll}) {
+            int events = decodeAll(rec, api);
+            double ns = nsPerCall([&] { doNotOptimize(decodeAll(rec, api)); });
+
+            double perEvent = ns / events;
+            double mbPerSec = stream.bytes.size() / (ns / 1e9) / 1e6;
+            std::fprintf(out(), "%-10s %-8s %10zu %10d %12.1f %10.1f\n",
+                         stream.name, apiName(api), stream.bytes.size(), events, perEvent, mbPerSec);
+
+            // Names from before the baseline was added stay as they were
+            std::string name = stream.name;
+            if (api != Api::Poll) name += std::string(" ") + apiName(api);
+            record("input", name + " ns/event", perEvent, "ns");
+            record("input", name + " throughput", mbPerSec, "MB/s");
+        }
+    }
+
+    double handoff = queueHandoffNs();
+    std::fprintf(out(), "\nSpscQueue between two threads: %.1f ns/event\n", handoff);
+    record("input", "queue handoff ns/event", handoff, "ns");
+    return true;
+}
+
+} // namespace bench
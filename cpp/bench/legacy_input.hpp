@@ -0,0 +1,39 @@
+#pragma once
+
+#include "bench.hpp"
+#include "input/input.hpp"
+
+namespace bench {
+
+// The parser input::InputHandler had before the table-driven state
+// machine, kept as the input group's baseline: every poll() refills a
+// 64-byte buffer and tries each sequence form by prefix matching from the
+// start of the event, with sscanf() for SGR mouse reports. Parsing only;
+// no wait()/wake().
+class LegacyInput {
+public:
+    explicit LegacyInput(int fd) : m_fd(fd) {}
+
+    std::optional<input::Event> poll();
+
+private:
+    bool read();
+    bool match(const char* seq, int len) const;
+    void consume(int n) { m_pos += n; }
+    int remaining() const { return m_len - m_pos; }
+    char peek(int offset) const;
+
+    bool parseCsi(input::Event& ev);
+    bool parseMouseSgr(input::Event& ev);
+    bool parseSs3(input::Event& ev);
+    bool parseAlt(input::Event& ev);
+    bool parseEscape(input::Event& ev);
+    bool parseChar(input::Event& ev);
+
+    int m_fd;
+    std::array<char, 64> m_buf = {};
+    int m_len = 0;
+    int m_pos = 0;
+};
+
+} // namespace bench
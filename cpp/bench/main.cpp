@@ -0,0 +1,68 @@
+#include "bench.hpp"
+
+#include <cstring>
+
+namespace {
+
+struct Group {
+    const char* name;
+    bool (*run)();
+};
+
+const Group GROUPS[] = {
+    {"diff", bench::runDiff},
+    {"sgr", bench::runSgr},
+    {"flush", bench::runFlush},
+    {"screen", bench::runScreen},
+    {"input", bench::runInput},
+    {"game", bench::runGame},
+    {"vt", bench::runVt},
+};
+
+} // namespace
+
+// bench-cpp [--json] [--cast <file>] [group...]: runs the named groups,
+// or all of them unless only a recorded session is given. With --json the
+// tables go to stderr and a JSON report to stdout.
+int main(int argc, char** argv) {
+    bool json = false;
+    const char* castPath = nullptr;
+    std::vector<const Group*> selected;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+            continue;
+        }
+        if (i + 1 < argc && std::strcmp(argv[i], "--cast") == 0) {
+            castPath = argv[++i];
+            continue;
+        }
+
+        const Group* group = nullptr;
+        for (const auto& g : GROUPS) {
+            if (std::strcmp(argv[i], g.name) == 0) group = &g;
+        }
+        if (!group) {
+            std::fprintf(stderr, "unknown group '%s'\n", argv[i]);
+            return 2;
+        }
+        selected.push_back(group);
+    }
+    if (selected.empty() && !castPath) {
+        for (const auto& g : GROUPS) selected.push_back(&g);
+    }
+
+    bench::setJson(json);
+    bool ok = true;
+    for (size_t i = 0; i < selected.size(); i++) {
+        if (i > 0) std::fprintf(bench::out(), "\n");
+        ok = selected[i]->run() && ok;
+    }
+    if (castPath) {
+        if (!selected.empty()) std::fprintf(bench::out(), "\n");
+        ok = bench::runCast(castPath) && ok;
+    }
+
+    if (json) bench::writeJson(stdout);
+    return ok ? 0 : 1;
+}
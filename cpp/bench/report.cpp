@@ -0,0 +1,55 @@
+#include "bench.hpp"
+
+namespace bench {
+
+namespace {
+
+struct Result {
+    const char* group;
+    std::string name;
+    double value;
+    const char* unit;
+};
+
+std::vector<Result> g_results;
+bool g_json = false;
+
+void writeString(FILE* f, std::string_view s) {
+    std::fputc('"', f);
+    for (char c : s) {
+        if (c == '"' || c == '\\') std::fputc('\\', f);
+        std::fputc(c, f);
+    }
+    std::fputc('"', f);
+}
+
+} // namespace
+
+FILE* out() {
+    return g_json ? stderr : stdout;
+}
+
+void record(const char* group, const std::string& name, double value, const char* unit) {
+    g_results.push_back({group, name, value, unit});
+}
+
+void setJson(bool json) {
+    g_json = json;
+}
+
+void writeJson(FILE* f) {
+    std::fprintf(f, "{\"results\": [");
+    for (size_t i = 0; i < g_results.size(); i++) {
+        const Result& r = g_results[i];
+        std::fprintf(f, "%s\n  {\"group\": ", i ? "," : "");
+        writeString(f, r.group);
+        std::fprintf(f, ", \"name\": ");
+        writeString(f, r.name);
+        std::fprintf(f, ", \"value\": %.3f, \"unit\": ", r.value);
+        writeString(f, r.unit);
+        std::fprintf(f, "}");
+    }
+    std::fprintf(f, "\n]}\n");
+}
+
+} // namespace bench
@@ -0,0 +1,95 @@
+#include "scene.hpp"
+#include "tui/diff.hpp"
+
+namespace bench {
+
+Scene::Scene(int width, int height)
+    : m_width(width), m_height(height), m_back(width * height), m_front(width * height) {}
+
+void Scene::put(int x, int y, std::string_view ch, tui::Color fg) {
+    if (x < 0 || x >= m_width || y < 0 || y >= m_height) return;
+    tui::Cell& c = m_back[y * m_width + x];
+    c.glyph = m_glyphs.intern(ch);
+    c.style = m_styles.intern(fg, tui::Color::None());
+}
+
+void Scene::text(int x, int y, std::string_view str) {
+    for (size_t i = 0; i < str.size(); i++) {
+        put(x + static_cast<int>(i), y, str.substr(i, 1), tui::Color::None());
+    }
+}
+
+void Scene::invalidate() {
+    for (auto& c : m_front) c.glyph = tui::Cell::INVALID_GLYPH;
+}
+
+void Scene::draw(int n) {
+    const auto border = tui::Color::Gray();
+    for (auto& c : m_back) c.clear();
+
+    int split = m_width * 2 / 3;
+    int bottom = m_height - 4;
+
+    for (int x = 0; x < m_width; x++) {
+        put(x, 0, "─", border);
+        put(x, bottom, "─", border);
+        put(x, m_height - 1, "─", border);
+    }
+    for (int y = 0; y < m_height; y++) {
+        put(0, y, "│", border);
+        put(m_width - 1, y, "│", border);
+        if (y < bottom) put(split, y, "│", border);
+    }
+    put(0, 0, "╭", border);
+    put(m_width - 1, 0, "╮", border);
+    put(0, m_height - 1, "╰", border);
+    put(m_width - 1, m_height - 1, "╯", border);
+    put(split, 0, "┬", border);
+    put(split, bottom, "┴", border);
+    put(0, bottom, "├", border);
+    put(m_width - 1, bottom, "┤", border);
+
+    text(split + 1, 1, " Score: " + std::to_string(n * 5));
+    text(split + 1, 2, " Time: " + std::to_string(n / 4) + "s");
+    text(1, bottom + 2, " Controls:    [<] / [a] Left    [>] / [d] Right");
+
+    // 11x11 grid laid out like ui::Grid::draw
+    const int cols = 11, rows = 11;
+    int bw = split - 1, bh = bottom - 1;
+    auto cellX = [&](int col) { return col * bw / cols + 1 + (bw / cols) / 2; };
+    auto cellY = [&](int row) { return row * bh / rows + 1 + (bh / rows) / 2; };
+
+    for (int i = 0; i < 10; i++) {
+        int col = (i * 5) % cols, row = i % 4;
+        put(cellX(col), cellY(row), "V", (n + i) % 3 == 0 ? tui::Color::Red() : tui::Color::White());
+        put(cellX(col), cellY(row + 1 + (n + i) % 6), "|", tui::Color::White());
+    }
+    put(cellX((n / 2) % cols), cellY(rows - 1), "A", tui::Color::Cyan());
+}
+
+void Scene::drawMenu() {
+    for (auto& c : m_back) c.clear();
+
+    const char* items[] = {"Resume", "Restart", "Settings", "Quit"};
+    int y = m_height / 2 - 3;
+    text(m_width / 2 - 3, y, "PAUSED");
+    for (const char* item : items) {
+        y += 2;
+        std::string_view label(item);
+        text(m_width / 2 - static_cast<int>(label.size()) / 2, y, label);
+    }
+}
+
+size_t Scene::encode(tui::Encoder& encoder, tui::OutputBuffer& out) {
+    out.clear();
+    encoder.begin(out, m_width);
+    for (int y = 0; y < m_height; y++) {
+        tui::Cell* back = &m_back[y * m_width];
+        tui::Cell* front = &m_front[y * m_width];
+        auto diff = tui::diffCells(back, front, m_width);
+        if (!diff.empty()) encoder.row(y, back, front, diff.first, diff.last);
+    }
+    return out.size();
+}
+
+} // namespace bench
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "bench.hpp"
+#include "tui/encoder.hpp"
+
+namespace bench {
+
+// Game-like screen rendered straight into cell buffers: box-drawing
+// borders, a stats column, and an 11x11 grid with enemies and bullets
+// that move every frame. Drives tui::Encoder without a terminal.
+class Scene {
+public:
+    Scene(int width, int height);
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    // Renders frame n into the back buffer
+    void draw(int n);
+
+    // Replaces the game with a centered menu, like ui::Menu over a
+    // cleared screen
+    void drawMenu();
+
+    // Encodes the changes since the previous frame, returns bytes emitted
+    size_t encode(tui::Encoder& encoder, tui::OutputBuffer& out);
+
+    tui::Encoder makeEncoder(tui::EncoderOptions options) {
+        return tui::Encoder(m_glyphs, m_sgr, options);
+    }
+
+    // Forgets what the terminal shows, so the next encode redraws all
+    void invalidate();
+
+private:
+    void put(int x, int y, std::string_view ch, tui::Color fg);
+    void text(int x, int y, std::string_view str);
+
+    int m_width, m_height;
+    tui::GlyphTable m_glyphs;
+    tui::StyleTable m_styles;
+    tui::SgrCache m_sgr{m_styles};
+    std::vector<tui::Cell> m_back;
+    std::vector<tui::Cell> m_front;
+};
+
+} // namespace bench
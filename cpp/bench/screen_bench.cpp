@@ -0,0 +1,106 @@
+#include "bench.hpp"
+#include "tui/screen.hpp"
+
+#include <random>
+
+namespace bench {
+
+namespace {
+
+struct Size {
+    int w, h;
+};
+
+std::unique_ptr<tui::Screen> headless(Size size) {
+    return std::make_unique<tui::Screen>(std::make_unique<tui::NullBackend>(size.w, size.h));
+}
+
+// Writes the frame-to-frame changes of a fixed fraction of the cells, then
+// flushes: only the flush is timed
+double flushNs(Size size, double changed) {
+    auto screen = headless(size);
+    screen->fill(0, 0, size.w, size.h, "─");
+    screen->fillColor(0, 0, size.w, size.h, tui::Color::Gray(), tui::Color::None());
+    screen->flush();
+
+    // Cells to toggle each frame, scattered like moving entities
+    std::mt19937 rng(1);
+    std::vector<std::pair<int, int>> cells;
+    int count = static_cast<int>(size.w * size.h * changed);
+    for (int i = 0; i < count; i++) {
+        cells.push_back({static_cast<int>(rng() % size.w), static_cast<int>(rng() % size.h)});
+    }
+    if (changed >= 1.0) {
+        cells.clear();
+        for (int y = 0; y < size.h; y++) {
+            for (int x = 0; x < size.w; x++) cells.push_back({x, y});
+        }
+    }
+
+    int frame = 0;
+    return nsPerPreparedCall(
+        [&] {
+            const char* glyph = (++frame % 2) ? "V" : "|";
+            for (auto [x, y] : cells) screen->putChar(x, y, glyph);
+        },
+        [&] { screen->flush(); });
+}
+
+// Damage that starts past column 0 must not widen the row's span to the
+// left: flush() compares and clear() blanks only from its first column
+bool damageSpanOk() {
+    auto screen = headless({250, 70});
+    screen->flush();
+    screen->putString(200, 5, "abcdef");
+    auto [x0, x1] = screen->damagedColumns(5);
+    if (x0 == 200 && x1 == 205) return true;
+
+    std::fprintf(out(), "  DAMAGE: columns 200..205 of an empty row tracked as %d..%d\n", x0, x1);
+    return false;
+}
+
+} // namespace
+
+bool runScreen() {
+    bool ok = damageSpanOk();
+
+    const Size sizes[] = {{80, 24}, {250, 70}};
+    const std::string ascii = " Score: 12345    Time: 1:05    Accuracy: 87%    Kills: 12 ";
+    const std::string multi = "╭──────────────── Menu ────────────────╮│ é ";
+
+    std::fprintf(out(), "Screen (ns per call, null backend)\n");
+    std::fprintf(out(), "%-10s %-22s %12s\n", "size", "operation", "ns");
+
+    for (auto size : sizes) {
+        char label[16];
+        std::snprintf(label, sizeof(label), "%dx%d", size.w, size.h);
+        auto screen = headless(size);
+
+        struct Op { const char* name; double ns; };
+        std::vector<Op> ops;
+
+        ops.push_back({"putString ascii", nsPerCall([&] {
+            screen->putString(1, 1, ascii);
+        })});
+        ops.push_back({"putString multi-byte", nsPerCall([&] {
+            screen->putString(1, 2, multi);
+        })});
+        ops.push_back({"fill", nsPerCall([&] {
+            screen->fill(0, 0, size.w, size.h, "─");
+        })});
+        ops.push_back({"fillColor", nsPerCall([&] {
+            screen->fillColor(0, 0, size.w, size.h, tui::Color::Gray(), tui::Color::Blue());
+        })});
+        ops.push_back({"flush 0% changed", flushNs(size, 0.0)});
+        ops.push_back({"flush 5% changed", flushNs(size, 0.05)});
+        ops.push_back({"flush 100% changed", flushNs(size, 1.0)});
+
+        for (const auto& op : ops) {
+            std::fprintf(out(), "%-10s %-22s %12.0f\n", label, op.name, op.ns);
+            record("screen", std::string(label) + " " + op.name, op.ns, "ns");
+        }
+    }
+    return ok;
+}
+
+} // namespace bench
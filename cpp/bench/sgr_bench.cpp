@@ -0,0 +1,111 @@
+#include "bench.hpp"
+#include "tui/sgr.hpp"
+
+#include <cstdio>
+
+namespace bench {
+
+namespace {
+
+// One emitted cell of a scripted frame, in flush() order
+struct Pen {
+    tui::Color fg;
+    tui::Color bg;
+    u8 attrs;
+};
+
+struct Frame {
+    const char* name;
+    std::vector<Pen> cells;
+    size_t budget;  // SGR bytes the encoder may spend on this frame
+};
+
+void run(std::vector<Pen>& out, int count, tui::Color fg, tui::Color bg = tui::Color::None(),
+         u8 attrs = tui::ATTR_NONE) {
+    for (int i = 0; i < count; i++) out.push_back({fg, bg, attrs});
+}
+
+// Borders, stats text and entities, like the game screen
+Frame gameFrame() {
+    using tui::Color;
+    Frame f{"game", {}, 888};
+    for (int row = 0; row < 20; row++) {
+        run(f.cells, 1, Color::Gray());
+        run(f.cells, row % 3 == 0 ? 1 : 0, Color::Red());
+        run(f.cells, row % 4 == 0 ? 1 : 0, Color::White());
+        run(f.cells, row == 18 ? 1 : 0, Color::Cyan());
+        run(f.cells, 1, Color::Gray());
+        run(f.cells, 12, Color::None());
+        run(f.cells, 1, Color::Gray());
+    }
+    return f;
+}
+
+// Centered menu: gray title, white entries, yellow marker
+Frame menuFrame() {
+    using tui::Color;
+    Frame f{"menu", {}, 76};
+    run(f.cells, 5, Color::Gray());
+    run(f.cells, 8, Color::White());
+    run(f.cells, 1, Color::Yellow());
+    run(f.cells, 8, Color::White());
+    run(f.cells, 4, Color::White());
+    return f;
+}
+
+// Status line that toggles attributes on a shared background
+Frame statusFrame() {
+    using tui::Color;
+    const Color bar = Color::RGB(40, 40, 60);
+    Frame f{"status", {}, 374};
+    for (int i = 0; i < 4; i++) {
+        run(f.cells, 6, Color::White(), bar, tui::ATTR_BOLD);
+        run(f.cells, 10, Color::White(), bar);
+        run(f.cells, 5, Color::Yellow(), bar, tui::ATTR_BOLD | tui::ATTR_UNDERLINE);
+        run(f.cells, 5, Color::Yellow(), bar, tui::ATTR_UNDERLINE);
+        run(f.cells, 8, Color::Gray(), bar, tui::ATTR_DIM);
+        run(f.cells, 3, Color::White(), bar, tui::ATTR_REVERSE);
+    }
+    return f;
+}
+
+// SGR bytes flush() emits for the frame: a full selection for the first
+// cell, then a transition whenever the pen changes
+size_t encodedBytes(const Frame& frame) {
+    tui::StyleTable styles;
+    tui::SgrCache sgr(styles);
+
+    size_t bytes = 0;
+    u32 last = 0;
+    bool first = true;
+    for (const auto& cell : frame.cells) {
+        u32 pen = sgr.pen(styles.intern(cell.fg, cell.bg), cell.attrs);
+        if (first) bytes += sgr.full(pen).size();
+        else if (pen != last) bytes += sgr.transition(last, pen).size();
+        last = pen;
+        first = false;
+    }
+    return bytes;
+}
+
+} // namespace
+
+bool runSgr() {
+    const Frame frames[] = {gameFrame(), menuFrame(), statusFrame()};
+    bool ok = true;
+
+    std::fprintf(out(), "SGR bytes per scripted frame\n");
+    std::fprintf(out(), "%-10s %8s %8s %8s\n", "frame", "cells", "bytes", "budget");
+
+    for (const auto& frame : frames) {
+        size_t bytes = encodedBytes(frame);
+        bool within = bytes <= frame.budget;
+        ok = ok && within;
+        std::fprintf(out(), "%-10s %8zu %8zu %8zu%s\n", frame.name, frame.cells.size(),
+                    bytes, frame.budget, within ? "" : "  REGRESSION");
+        record("sgr", frame.name, bytes, "bytes");
+    }
+    return ok;
+}
+
+} // namespace bench
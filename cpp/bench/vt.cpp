@@ -0,0 +1,309 @@
+#include "vt.hpp"
+#include "tui/screen.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace bench {
+
+namespace {
+
+// Colors as the terminal sees them: unset, or 24-bit RGB
+bool sameColor(tui::Color a, tui::Color b) {
+    if (a.isSet() != b.isSet()) return false;
+    return !a.isSet() || (a.value & 0xFFFFFF) == (b.value & 0xFFFFFF);
+}
+
+std::string describe(std::string_view glyph, tui::Color fg, tui::Color bg, u8 attrs) {
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "'%.*s' fg %08x bg %08x attrs %02x",
+                  static_cast<int>(glyph.size()), glyph.data(), fg.value, bg.value, attrs);
+    return buf;
+}
+
+} // namespace
+
+VirtualTerminal::VirtualTerminal(int width, int height)
+    : m_width(width), m_height(height), m_cells(static_cast<size_t>(width) * height) {}
+
+void VirtualTerminal::feed(std::string_view bytes) {
+    m_counts.bytes += bytes.size();
+
+    for (char ch : bytes) {
+        u8 c = static_cast<u8>(ch);
+
+        switch (m_state) {
+        case State::Ground:
+            if (!m_utf8.empty()) {
+                if ((c & 0xC0) == 0x80) {
+                    m_utf8 += ch;
+                    if (m_utf8.size() == m_utf8Len) {
+                        print(m_utf8);
+                        m_utf8.clear();
+                    }
+                    continue;
+                }
+                // Truncated character
+                m_utf8.clear();
+                m_counts.unknown++;
+            }
+
+            if (c == 0x1b) {
+                m_state = State::Escape;
+            } else if (c == '\r') {
+                moveTo(0, m_y);
+                m_counts.moves++;
+            } else if (c == '\n') {
+                lineFeed();
+                m_counts.moves++;
+            } else if (c < 0x20 || c == 0x7f) {
+                m_counts.unknown++;
+            } else if (c < 0x80) {
+                print(std::string_view(&ch, 1));
+            } else if (c >= 0xC0 && c < 0xF8) {
+                m_utf8 = ch;
+                m_utf8Len = c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+            } else {
+                m_counts.unknown++;
+            }
+            break;
+
+        case State::Escape:
+            if (c == '[') {
+                m_state = State::Csi;
+                m_params.assign(1, -1);
+                m_private = false;
+                m_intermediate.clear();
+            } else {
+                m_state = State::Ground;
+                m_counts.unknown++;
+            }
+            break;
+
+        case State::Csi:
+            if (c >= '0' && c <= '9') {
+                int& p = m_params.back();
+                p = std::min((p < 0 ? 0 : p) * 10 + (c - '0'), 99999);
+            } else if (c == ';' || c == ':') {
+                m_params.push_back(-1);
+            } else if (c >= '<' && c <= '?') {
+                m_private = true;
+            } else if (c >= 0x20 && c <= 0x2F) {
+                m_intermediate += ch;
+            } else if (c >= 0x40 && c <= 0x7E) {
+                m_state = State::Ground;
+                csi(ch);
+            } else {
+                m_state = State::Ground;
+                m_counts.unknown++;
+            }
+            break;
+        }
+    }
+}
+
+bool VirtualTerminal::matches(const tui::Screen& screen, std::string* why) const {
+    if (screen.width() != m_width || screen.height() != m_height) {
+        if (why) *why = "size differs";
+        return false;
+    }
+
+    for (int y = 0; y < m_height; y++) {
+        for (int x = 0; x < m_width; x++) {
+            const Cell& t = at(x, y);
+            auto s = screen.contents(x, y);
+            if (t.glyph == s.glyph && t.attrs == s.attrs &&
+                sameColor(t.fg, s.fg) && sameColor(t.bg, s.bg)) {
+                continue;
+            }
+
+            if (why) {
+                char pos[32];
+                std::snprintf(pos, sizeof(pos), "cell %d,%d: ", x, y);
+                *why = pos + describe(t.glyph, t.fg, t.bg, t.attrs) +
+                       ", drawn " + describe(s.glyph, s.fg, s.bg, s.attrs);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+void VirtualTerminal::print(std::string_view glyph) {
+    if (m_wrapPending) {
+        m_x = 0;
+        lineFeed();
+    }
+
+    Cell& c = m_cells[m_y * m_width + m_x];
+    c.glyph.assign(glyph.data(), glyph.size());
+    c.fg = m_fg;
+    c.bg = m_bg;
+    c.attrs = m_attrs;
+    m_lastGlyph = c.glyph;
+    m_counts.glyphs++;
+
+    if (m_x + 1 < m_width) {
+        m_x++;
+    } else {
+        m_wrapPending = true;
+    }
+}
+
+void VirtualTerminal::lineFeed() {
+    m_wrapPending = false;
+    if (m_y + 1 < m_height) {
+        m_y++;
+        return;
+    }
+
+    // Scroll up, the new bottom row is erased
+    std::rotate(m_cells.begin(), m_cells.begin() + m_width, m_cells.end());
+    erase(m_height - 1, 0, m_width - 1);
+}
+
+void VirtualTerminal::moveTo(int x, int y) {
+    m_x = std::clamp(x, 0, m_width - 1);
+    m_y = std::clamp(y, 0, m_height - 1);
+    m_wrapPending = false;
+}
+
+void VirtualTerminal::erase(int y, int x0, int x1) {
+    // Erased cells keep the current background only
+    for (int x = std::max(x0, 0); x <= std::min(x1, m_width - 1); x++) {
+        Cell& c = m_cells[y * m_width + x];
+        c.glyph = " ";
+        c.fg = tui::Color::None();
+        c.bg = m_bg;
+        c.attrs = tui::ATTR_NONE;
+    }
+}
+
+int VirtualTerminal::param(size_t i, int fallback) const {
+    return i < m_params.size() && m_params[i] >= 0 ? m_params[i] : fallback;
+}
+
+void VirtualTerminal::csi(char final) {
+    if (m_private || !m_intermediate.empty()) {
+        // DEC private modes (?25l, ?2026h, ...) and DECRQM ($p)
+        if (final == 'h' || final == 'l' || final == 'p') {
+            m_counts.modes++;
+        } else {
+            m_counts.unknown++;
+        }
+        return;
+    }
+
+    int n = std::max(param(0, 1), 1);
+    switch (final) {
+    case 'H':
+    case 'f':
+        moveTo(std::max(param(1, 1), 1) - 1, n - 1);
+        m_counts.cup++;
+        break;
+    case 'A': moveTo(m_x, m_y - n); m_counts.moves++; break;
+    case 'B': moveTo(m_x, m_y + n); m_counts.moves++; break;
+    case 'C': moveTo(m_x + n, m_y); m_counts.moves++; break;
+    case 'D': moveTo(m_x - n, m_y); m_counts.moves++; break;
+    case 'G': moveTo(n - 1, m_y); m_counts.moves++; break;
+    case 'd': moveTo(m_x, n - 1); m_counts.moves++; break;
+
+    case 'J':
+        switch (param(0, 0)) {
+        case 0:
+            erase(m_y, m_x, m_width - 1);
+            for (int y = m_y + 1; y < m_height; y++) erase(y, 0, m_width - 1);
+            break;
+        case 1:
+            for (int y = 0; y < m_y; y++) erase(y, 0, m_width - 1);
+            erase(m_y, 0, m_x);
+            break;
+        default:
+            for (int y = 0; y < m_height; y++) erase(y, 0, m_width - 1);
+            break;
+        }
+        m_wrapPending = false;
+        m_counts.erase++;
+        break;
+    case 'K':
+        switch (param(0, 0)) {
+        case 0: erase(m_y, m_x, m_width - 1); break;
+        case 1: erase(m_y, 0, m_x); break;
+        default: erase(m_y, 0, m_width - 1); break;
+        }
+        m_wrapPending = false;
+        m_counts.erase++;
+        break;
+    case 'X':
+        erase(m_y, m_x, m_x + n - 1);
+        m_wrapPending = false;
+        m_counts.erase++;
+        break;
+
+    case 'b': {
+        std::string glyph = m_lastGlyph;
+        for (int i = 0; i < n; i++) print(glyph);
+        m_counts.repeat++;
+        break;
+    }
+    case 'm':
+        sgr();
+        m_counts.sgr++;
+        break;
+    case 'c':
+        m_counts.modes++;  // DA1 query
+        break;
+    default:
+        m_counts.unknown++;
+        break;
+    }
+}
+
+void VirtualTerminal::sgr() {
+    for (size_t i = 0; i < m_params.size(); i++) {
+        int p = std::max(m_params[i], 0);
+        switch (p) {
+        case 0:
+            m_fg = tui::Color::None();
+            m_bg = tui::Color::None();
+            m_attrs = tui::ATTR_NONE;
+            break;
+        case 1: m_attrs |= tui::ATTR_BOLD; break;
+        case 2: m_attrs |= tui::ATTR_DIM; break;
+        case 3: m_attrs |= tui::ATTR_ITALIC; break;
+        case 4: m_attrs |= tui::ATTR_UNDERLINE; break;
+        case 5: m_attrs |= tui::ATTR_BLINK; break;
+        case 7: m_attrs |= tui::ATTR_REVERSE; break;
+        case 9: m_attrs |= tui::ATTR_CROSSED; break;
+        case 22: m_attrs &= ~(tui::ATTR_BOLD | tui::ATTR_DIM); break;
+        case 23: m_attrs &= ~tui::ATTR_ITALIC; break;
+        case 24: m_attrs &= ~tui::ATTR_UNDERLINE; break;
+        case 25: m_attrs &= ~tui::ATTR_BLINK; break;
+        case 27: m_attrs &= ~tui::ATTR_REVERSE; break;
+        case 29: m_attrs &= ~tui::ATTR_CROSSED; break;
+        case 39: m_fg = tui::Color::None(); break;
+        case 49: m_bg = tui::Color::None(); break;
+
+        case 38:
+        case 48:
+            if (param(i + 1, 0) == 2 && i + 4 < m_params.size()) {
+                tui::Color color = tui::Color::RGB(
+                    static_cast<u8>(param(i + 2, 0)), static_cast<u8>(param(i + 3, 0)),
+                    static_cast<u8>(param(i + 4, 0)));
+                (p == 38 ? m_fg : m_bg) = color;
+                i += 4;
+            } else {
+                // 256-color and malformed forms are never emitted
+                m_counts.unknown++;
+                return;
+            }
+            break;
+
+        default:
+            m_counts.unknown++;
+            break;
+        }
+    }
+}
+
+} // namespace bench
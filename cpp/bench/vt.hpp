@@ -0,0 +1,88 @@
+#pragma once
+
+#include "bench.hpp"
+#include "tui/color.hpp"
+
+namespace tui { class Screen; }
+
+namespace bench {
+
+// Model of the terminal on the other end of Screen::flush(): decodes the
+// subset of VT sequences the encoder emits (CUP and relative moves, SGR
+// with truecolor and the attributes, ED/EL/ECH, REP, UTF-8 text) into a
+// cell grid, and counts what it was fed. Input may be split anywhere, the
+// parser keeps its state between feed() calls.
+class VirtualTerminal {
+public:
+    struct Cell {
+        std::string glyph = " ";
+        tui::Color fg;
+        tui::Color bg;
+        u8 attrs = tui::ATTR_NONE;
+    };
+
+    struct Counts {
+        u64 bytes = 0;
+        u64 glyphs = 0;   // cells printed, REP included
+        u64 cup = 0;      // CUP
+        u64 moves = 0;    // CUU/CUD/CUF/CUB/CHA/VPA, CR, LF
+        u64 sgr = 0;
+        u64 erase = 0;    // ED, EL, ECH
+        u64 repeat = 0;   // REP
+        u64 modes = 0;    // mode changes and queries, no effect on the grid
+        u64 unknown = 0;  // sequences and controls the model does not handle
+
+        u64 sequences() const { return cup + moves + sgr + erase + repeat + modes + unknown; }
+    };
+
+    VirtualTerminal(int width, int height);
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    void feed(std::string_view bytes);
+
+    const Cell& at(int x, int y) const { return m_cells[y * m_width + x]; }
+
+    const Counts& counts() const { return m_counts; }
+    void resetCounts() { m_counts = {}; }
+
+    // Compares the grid with the back buffer of screen. On a mismatch
+    // returns false and describes the first differing cell in why.
+    bool matches(const tui::Screen& screen, std::string* why = nullptr) const;
+
+private:
+    enum class State { Ground, Escape, Csi };
+
+    void print(std::string_view glyph);
+    void lineFeed();
+    void moveTo(int x, int y);
+    void erase(int y, int x0, int x1);
+    void csi(char final);
+    void sgr();
+    int param(size_t i, int fallback) const;
+
+    int m_width, m_height;
+    std::vector<Cell> m_cells;
+    Counts m_counts;
+
+    int m_x = 0;
+    int m_y = 0;
+    bool m_wrapPending = false;  // last column written, wraps on the next glyph
+
+    // Current pen
+    tui::Color m_fg;
+    tui::Color m_bg;
+    u8 m_attrs = tui::ATTR_NONE;
+
+    std::string m_lastGlyph = " ";  // for REP
+
+    State m_state = State::Ground;
+    std::string m_utf8;          // partial UTF-8 character
+    size_t m_utf8Len = 0;        // its expected length
+    std::vector<int> m_params;   // CSI parameters, -1 when omitted
+    bool m_private = false;      // CSI with a '<', '=', '>' or '?' prefix
+    std::string m_intermediate;  // CSI intermediate bytes
+};
+
+} // namespace bench
@@ -0,0 +1,224 @@
+#include "bench.hpp"
+#include "vt.hpp"
+#include "tui/screen.hpp"
+
+#include <random>
+
+namespace bench {
+
+namespace {
+
+constexpr int FRAMES = 400;
+
+struct Encoding {
+    const char* name;
+    tui::EncoderOptions options;
+};
+
+// Game screen drawn through the Screen API: borders, stats, a dotted
+// field with moving enemies, bullets and the player
+void drawGame(tui::Screen& s, int n) {
+    int w = s.width(), h = s.height();
+    int split = w * 2 / 3;
+    int bottom = h - 4;
+
+    s.clear();
+    s.fill(0, 0, w, 1, "─");
+    s.fill(0, bottom, w, 1, "─");
+    s.fill(0, h - 1, w, 1, "─");
+    s.fill(0, 0, 1, h, "│");
+    s.fill(w - 1, 0, 1, h, "│");
+    s.fill(split, 0, 1, bottom, "│");
+    s.putChar(0, 0, "╭");
+    s.putChar(w - 1, 0, "╮");
+    s.putChar(0, h - 1, "╰");
+    s.putChar(w - 1, h - 1, "╯");
+    s.fillColor(0, 0, w, h, tui::Color::Gray(), tui::Color::None());
+
+    s.putString(split + 2, 1, "Score: " + std::to_string(n * 5));
+    s.putString(split + 2, 2, "Time: " + std::to_string(n / 4) + "s");
+    for (int x = split + 2; x < split + 9; x++) s.setAttr(x, 1, tui::ATTR_BOLD);
+    s.putString(2, bottom + 2, "Controls:    [<] / [a] Left    [>] / [d] Right");
+
+    for (int y = 2; y < bottom - 1; y += 2) {
+        for (int x = 2; x < split - 1; x += 3) {
+            s.putChar(x, y, "·");
+            s.setAttr(x, y, tui::ATTR_DIM);
+        }
+    }
+
+    for (int i = 0; i < 10; i++) {
+        int x = 2 + (i * 7 + n) % (split - 3);
+        int y = 2 + i % 4;
+        s.putChar(x, y, "V");
+        s.fillColor(x, y, 1, 1, (n + i) % 3 ? tui::Color::Red() : tui::Color::Magenta(),
+                    tui::Color::None());
+        s.putChar(x, y + 1 + (n + i) % 6, "|");
+        s.fillColor(x, y + 1 + (n + i) % 6, 1, 1, tui::Color::Yellow(), tui::Color::None());
+    }
+
+    int px = 2 + (n / 2) % (split - 3);
+    s.putChar(px, bottom - 1, "A");
+    s.fillColor(px, bottom - 1, 1, 1, tui::Color::Cyan(), tui::Color::RGB(0, 0, 64));
+    s.setAttr(px, bottom - 1, tui::ATTR_BOLD | tui::ATTR_UNDERLINE);
+}
+
+// Centered menu over a cleared screen, with the selection in reverse
+void drawMenu(tui::Screen& s, int selected) {
+    const char* items[] = {"Resume", "Restart", "Settings", "Quit"};
+    s.clear();
+
+    int y = s.height() / 2 - 3;
+    s.putString(s.width() / 2 - 3, y, "PAUSED");
+    for (int i = 0; i < 4; i++) {
+        y += 2;
+        std::string label = std::string(i == selected ? "> " : "  ") + items[i];
+        int x = s.width() / 2 - static_cast<int>(label.size()) / 2;
+        s.putString(x, y, label);
+        if (i == selected) {
+            for (size_t k = 0; k < label.size(); k++) {
+                s.setAttr(x + static_cast<int>(k), y, tui::ATTR_REVERSE);
+            }
+        }
+    }
+}
+
+// Random cells and runs in random colors and attributes: blanks, repeats
+// and pen changes in every combination the encoder can meet
+void scramble(tui::Screen& s, std::mt19937& rng) {
+    const char* glyphs[] = {" ", " ", "a", "#", "─", "é", "█", "V"};
+    const tui::Color colors[] = {
+        tui::Color::None(), tui::Color::None(), tui::Color::Red(),
+        tui::Color::RGB(1, 2, 3), tui::Color::Gray(), tui::Color::White(),
+    };
+    const u8 attrs[] = {
+        tui::ATTR_NONE, tui::ATTR_NONE, tui::ATTR_BOLD, tui::ATTR_DIM,
+        tui::ATTR_BOLD | tui::ATTR_DIM, tui::ATTR_ITALIC | tui::ATTR_CROSSED,
+        tui::ATTR_UNDERLINE | tui::ATTR_BLINK, tui::ATTR_REVERSE,
+    };
+    auto pick = [&](auto& table) -> const auto& {
+        return table[rng() % (sizeof(table) / sizeof(table[0]))];
+    };
+
+    if (rng() % 40 == 0) s.clear();
+
+    int runs = 1 + static_cast<int>(rng() % 12);
+    for (int i = 0; i < runs; i++) {
+        int y = static_cast<int>(rng() % s.height());
+        int x = static_cast<int>(rng() % s.width());
+        int len = 1 + static_cast<int>(rng() % (rng() % 4 ? 6 : s.width()));
+
+        s.fill(x, y, len, 1, pick(glyphs));
+        s.fillColor(x, y, len, 1, pick(colors), pick(colors));
+        u8 a = pick(attrs);
+        for (int k = 0; k < len; k++) s.setAttr(x + k, y, a);
+    }
+}
+
+struct Result {
+    u64 frames = 0;
+    VirtualTerminal::Counts counts;
+    std::string mismatch;  // empty when every frame decoded to m_back
+};
+
+// Draws FRAMES frames with draw(screen, n), decodes the output of every
+// flush and compares the decoded grid with the back buffer
+template <typename Draw>
+Result verify(int w, int h, tui::EncoderOptions options, Draw&& draw) {
+    auto memory = std::make_unique<tui::MemoryBackend>(w, h);
+    tui::MemoryBackend& backend = *memory;
+    tui::Screen screen(std::move(memory));
+    screen.setEncoderOptions(options);
+    VirtualTerminal vt(w, h);
+
+    Result result;
+    for (int n = 0; n < FRAMES; n++) {
+        draw(screen, n);
+        if (n % 97 == 96) {
+            screen.flushFull();
+        } else {
+            screen.flush();
+        }
+
+        vt.feed(backend.bytes());
+        backend.clearBytes();
+        result.frames++;
+
+        if (!vt.matches(screen, &result.mismatch)) {
+            result.mismatch = "frame " + std::to_string(n) + ", " + result.mismatch;
+            break;
+        }
+    }
+    result.counts = vt.counts();
+    return result;
+}
+
+} // namespace
+
+bool runVt() {
+    struct Size { int w, h; };
+    const Size sizes[] = {{80, 24}, {250, 70}};
+
+    tui::EncoderOptions cup;
+    cup.relativeMoves = false;
+    cup.erase = false;
+    tui::EncoderOptions relative = cup;
+    relative.relativeMoves = true;
+    tui::EncoderOptions all;
+    all.repeat = true;
+    const Encoding encodings[] = {{"cup", cup}, {"relative", relative}, {"all", all}};
+
+    std::fprintf(out(), "Flush output decoded by a virtual terminal (%d frames, per frame)\n", FRAMES);
+    std::fprintf(out(), "%-10s %-8s %-9s %9s %7s %7s %7s %7s %7s %7s\n", "size", "scene",
+                 "encoder", "bytes", "seqs", "cup", "moves", "sgr", "erase", "rep");
+
+    bool ok = true;
+    for (auto size : sizes) {
+        char label[16];
+        std::snprintf(label, sizeof(label), "%dx%d", size.w, size.h);
+
+        for (const auto& enc : encodings) {
+            std::mt19937 rng(1);
+            struct Run { const char* name; Result result; };
+            const Run runs[] = {
+                {"game", verify(size.w, size.h, enc.options, [](tui::Screen& s, int n) {
+                    if (n % 50 >= 45) {
+                        drawMenu(s, n % 4);
+                    } else {
+                        drawGame(s, n);
+                    }
+                })},
+                {"random", verify(size.w, size.h, enc.options, [&](tui::Screen& s, int) {
+                    scramble(s, rng);
+                })},
+            };
+
+            for (const auto& run : runs) {
+                const Result& r = run.result;
+                double frames = static_cast<double>(r.frames);
+                auto per = [&](u64 v) { return static_cast<double>(v) / frames; };
+
+                std::fprintf(out(), "%-10s %-8s %-9s %9.1f %7.1f %7.1f %7.1f %7.1f %7.1f %7.1f\n",
+                             label, run.name, enc.name, per(r.counts.bytes),
+                             per(r.counts.sequences()), per(r.counts.cup), per(r.counts.moves),
+                             per(r.counts.sgr), per(r.counts.erase), per(r.counts.repeat));
+
+                std::string name = std::string(label) + " " + run.name + " " + enc.name;
+                record("vt", name + " bytes", per(r.counts.bytes), "bytes/frame");
+                record("vt", name + " sequences", per(r.counts.sequences()), "seqs/frame");
+
+                if (!r.mismatch.empty()) {
+                    std::fprintf(out(), "  MISMATCH: %s\n", r.mismatch.c_str());
+                    ok = false;
+                } else if (r.counts.unknown > 0) {
+                    std::fprintf(out(), "  %llu sequences the model does not handle\n",
+                                 static_cast<unsigned long long>(r.counts.unknown));
+                    ok = false;
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+} // namespace bench
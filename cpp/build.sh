@@ -11,9 +11,23 @@ LIBS=
 
 SRCS=(
     src/main.cpp
+    src/app.cpp
+    src/benchmark.cpp
+    src/scenario.cpp
+    src/alloc.cpp
     src/tui/terminal.cpp
     src/tui/screen.cpp
+    src/tui/diff.cpp
+    src/tui/glyph.cpp
+    src/tui/style.cpp
+    src/tui/sgr.cpp
+    src/tui/encoder.cpp
+    src/tui/output.cpp
+    src/tui/writer.cpp
+    src/tui/backend.cpp
+    src/tui/cast.cpp
     src/input/input.cpp
+    src/input/replay.cpp
     src/ui/frame.cpp
     src/ui/grid.cpp
     src/ui/menu.cpp
@@ -0,0 +1,79 @@
+#include "alloc.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<u64> g_count{0};
+std::atomic<u64> g_bytes{0};
+
+void* allocate(size_t size) {
+    g_count.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* allocate(size_t size, std::align_val_t alignment) {
+    g_count.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    // aligned_alloc() wants the size to be a multiple of the alignment
+    size_t align = static_cast<size_t>(alignment);
+    size_t rounded = ((size ? size : 1) + align - 1) / align * align;
+    void* p = std::aligned_alloc(align, rounded);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+template <typename... Args>
+void* allocateNothrow(Args... args) noexcept {
+    try {
+        return allocate(args...);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+} // namespace
+
+namespace alloc {
+
+u64 count() { return g_count.load(std::memory_order_relaxed); }
+u64 bytes() { return g_bytes.load(std::memory_order_relaxed); }
+
+} // namespace alloc
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+// Over-aligned types (alignas above the default, e.g. the input queue)
+void* operator new(size_t size, std::align_val_t align) { return allocate(size, align); }
+void* operator new[](size_t size, std::align_val_t align) { return allocate(size, align); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+// nothrow forms, counted the same
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocateNothrow(size);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return allocateNothrow(size);
+}
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocateNothrow(size, align);
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return allocateNothrow(size, align);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "common.hpp"
+
+// Heap allocation counters. The game binary replaces every global operator
+// new/delete (plain, sized, aligned and nothrow) to keep them; the counting
+// is a relaxed atomic increment.
+namespace alloc {
+
+// Calls to operator new since the program started
+u64 count();
+
+// Bytes requested from operator new since the program started
+u64 bytes();
+
+} // namespace alloc
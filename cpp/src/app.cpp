@@ -0,0 +1,495 @@
+#include "app.hpp"
+#include "ui/panel.hpp"
+#include "game/level.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <chrono>
+
+Application::Application(std::unique_ptr<tui::Backend> backend)
+    : m_screen(std::move(backend))
+    , m_game(11, 11, TICKS_PER_SECOND)
+    , m_rootFrame(m_screen.width(), m_screen.height(), 0, 0) {
+
+    setupGame();
+    setupLayout();
+    setupMenu();
+    m_pending.reserve(INPUT_QUEUE_CAPACITY);
+    m_sampleHeldKeys = m_screen.backend().keyReleases();
+}
+
+void Application::run() {
+    // Keep tty writes out of the tick
+    m_screen.setAsyncOutput(true);
+    render();
+
+    std::vector<i64> state;
+    if (m_recorder) {
+        saveState(state);
+        m_recorder->keyframe(m_tickCount, state);
+    }
+
+    std::thread inputThread(&Application::inputLoop, this);
+
+    auto sleepTime = std::chrono::microseconds(US_PER_SEC / m_game.tps());
+
+    while (m_running) {
+        applyQueuedInput();
+        if (!m_running) break;
+
+        tick(sleepTime.count());
+        if (m_recorder && m_tickCount % KEYFRAME_INTERVAL == 0) {
+            state.clear();
+            saveState(state);
+            m_recorder->keyframe(m_tickCount, state);
+        }
+        render();
+
+        std::this_thread::sleep_for(sleepTime);
+    }
+
+    m_running = false;
+    m_input.wake();
+    inputThread.join();
+
+    if (m_recorder) m_recorder->finish(m_tickCount);
+}
+
+void Application::replay(const input::Replay& replay, bool realTime) {
+    m_screen.setAsyncOutput(true);
+
+    // Seek targets by tick. The state we start in is the recording's tick 0,
+    // so files without keyframes can still be rewound.
+    input::Keyframe start{0, {}};
+    saveState(start.state);
+    std::vector<const input::Keyframe*> keyframes;
+    if (replay.keyframes.empty() || replay.keyframes.front().tick > 0) {
+        keyframes.push_back(&start);
+    }
+    for (const auto& kf : replay.keyframes) keyframes.push_back(&kf);
+
+    const i64 dt = US_PER_SEC / replay.tps;
+    size_t next = 0;  // first event not applied yet
+    bool paused = false;
+    bool atEnd = false;  // paused on the last recorded tick until a seek or 'q'
+    bool quit = false;
+
+    auto show = [&]() {
+        draw();
+        drawReplayStatus(replay.ticks, atEnd ? "(end)" : paused ? "(paused)" : "");
+        m_screen.flush();
+    };
+
+    // Events recorded up to the current tick. Like in run(), the next
+    // frame shows them together with the tick.
+    auto applyEvents = [&]() {
+        for (; next < replay.events.size() && replay.events[next].tick <= m_tickCount; next++) {
+            processInput(replay.events[next].event);
+        }
+    };
+
+    // Restores the last keyframe at or before tick and simulates the rest,
+    // at most KEYFRAME_INTERVAL ticks for a recorded file
+    auto seek = [&](u64 tick) {
+        auto it = std::upper_bound(keyframes.begin(), keyframes.end(), tick,
+            [](u64 t, const input::Keyframe* kf) { return t < kf->tick; });
+        const input::Keyframe* kf = *std::prev(it);
+
+        loadState(kf->state);
+        m_running = true;
+        m_tickCount = kf->tick;
+        next = std::lower_bound(replay.events.begin(), replay.events.end(), kf->tick,
+            [](const input::RecordedEvent& ev, u64 t) { return ev.tick < t; }) - replay.events.begin();
+
+        while (m_tickCount < tick && m_running) {
+            applyEvents();
+            this->tick(dt);
+        }
+    };
+
+    auto keyframeBefore = [&]() {
+        u64 target = 0;
+        for (const auto* kf : keyframes) {
+            if (kf->tick < m_tickCount) target = kf->tick;
+        }
+        return target;
+    };
+
+    auto keyframeAfter = [&]() -> std::optional<u64> {
+        for (const auto* kf : keyframes) {
+            if (kf->tick > m_tickCount && kf->tick <= replay.ticks) return kf->tick;
+        }
+        return std::nullopt;
+    };
+
+    auto period = std::chrono::microseconds(dt);
+    auto deadline = std::chrono::steady_clock::now();
+    show();
+
+    while (!quit) {
+        applyEvents();
+        if (!atEnd && (!m_running || m_tickCount >= replay.ticks)) {
+            // Keep the last frame up so it can still be inspected or rewound;
+            // a seek from here stays paused
+            atEnd = true;
+            paused = true;
+            show();
+        }
+
+        if (!paused) {
+            tick(dt);
+            show();
+        }
+
+        while (auto ev = m_input.poll()) {
+            auto* key = std::get_if<input::KeyEvent>(&*ev);
+            if (key && key->action == input::KeyAction::Release) continue;
+
+            if (input::InputHandler::isChar(*ev, 'q')) {
+                quit = true;
+            } else if (input::InputHandler::isKey(*ev, input::KeyCode::Left)) {
+                seek(keyframeBefore());
+                atEnd = false;
+                show();
+            } else if (input::InputHandler::isKey(*ev, input::KeyCode::Right)) {
+                if (auto t = keyframeAfter()) {
+                    seek(*t);
+                    atEnd = false;
+                }
+                show();
+            } else if (input::InputHandler::isChar(*ev, ' ') && !atEnd) {
+                paused = !paused;
+                deadline = std::chrono::steady_clock::now();
+                show();
+            }
+        }
+
+        if (quit) {
+            break;
+        } else if (paused) {
+            m_input.wait();  // nothing changes until the next key
+        } else if (realTime) {
+            deadline += period;
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+}
+
+void Application::drawReplayStatus(u64 totalTicks, const char* state) {
+    std::string label = state;
+    label.resize(8, ' ');  // keeps the tick counter in place
+    std::string status = " REPLAY " + label +
+                         "  tick " + std::to_string(m_tickCount) + "/" + std::to_string(totalTicks) +
+                         "    [<] / [>] Keyframe    [space] Pause    [q] Quit";
+    int y = m_screen.height() - 1;
+    m_screen.fill(0, y, m_screen.width(), 1, " ");
+    m_screen.putString(0, y, status);
+    for (int x = 0; x < m_screen.width(); x++) {
+        m_screen.setAttr(x, y, tui::ATTR_REVERSE);
+    }
+}
+
+void Application::saveState(std::vector<i64>& out) const {
+    out.insert(out.end(), {
+        static_cast<i64>(m_currentScreen),
+        m_menu.currentIndex(),
+        m_gameOverMenu.currentIndex(),
+        m_winMenu.currentIndex(),
+    });
+    m_game.saveState(out);
+}
+
+void Application::loadState(const std::vector<i64>& state) {
+    game::StateReader in(state);
+    m_currentScreen = static_cast<ScreenType>(in.next());
+    m_menu.setCurrentIndex(in.nextInt());
+    m_gameOverMenu.setCurrentIndex(in.nextInt());
+    m_winMenu.setCurrentIndex(in.nextInt());
+    m_game.loadState(in);
+}
+
+void Application::tick(i64 deltaTime) {
+    m_tickCount++;
+    if (m_game.status() != game::GameStatus::Running) return;
+
+    m_game.update(deltaTime);
+    m_game.removeDeadEntities();
+
+    // Check level completion
+    if (m_game.enemies().empty() && m_game.player() && m_game.player()->isAlive()) {
+        m_game.incrementLevel();
+        if (m_game.level() > game::LEVEL_COUNT) {
+            m_game.setStatus(game::GameStatus::Finished);
+            m_currentScreen = ScreenType::Win;
+        } else {
+            game::spawnLevel(m_game, game::LEVELS[m_game.level() - 1]);
+        }
+    }
+
+    if (m_game.status() == game::GameStatus::GameOver) {
+        m_currentScreen = ScreenType::GameOver;
+    }
+}
+
+void Application::setupGame() {
+    m_game.spawnPlayer((m_game.bounds().w - 1) / 2,
+                       m_game.bounds().h - 1, 5, 1, 2);
+    game::spawnLevel(m_game, game::LEVELS[0]);
+}
+
+void Application::setupLayout() {
+    auto split1 = m_rootFrame.split(
+        m_rootFrame.height() - 4, ui::FrameSplit::Horizontal);
+    ui::Frame& topFrame = split1.first;
+    ui::Frame& bottomFrame = split1.second;
+
+    auto split2 = topFrame.split(
+        topFrame.width() * 2 / 3, ui::FrameSplit::Vertical);
+    ui::Frame& gameFrame = split2.first;
+    ui::Frame& statsFrame = split2.second;
+
+    auto controls = std::make_unique<ui::Panel>();
+    controls->addEmptyLine();
+    controls->addText(" Controls:    [<] / [a] Left    [>] / [d] Right "
+                     "   [space] Shoot    [q] Quit    [m] Menu");
+    bottomFrame.addWidget(std::move(controls));
+
+    auto stats = std::make_unique<ui::Panel>();
+    game::Game* g = &m_game;
+    stats->addValue(" Level", [g]() { return std::to_string(g->level()); });
+    stats->addValue(" Score", [g]() { return std::to_string(g->score()); });
+    stats->addValue(" Lives", [g]() {
+        return g->player() ? std::to_string(g->player()->health()) : std::string("-");
+    });
+    stats->addEmptyLine();
+    stats->addValue(" Kills", [g]() { return std::to_string(g->kills()); });
+    stats->addValue(" Accuracy", [g]() { return std::to_string(g->accuracyPercent()) + "%"; });
+    stats->addValue(" Time", [g]() {
+        int secs = g->timeSeconds();
+        int mins = secs / 60;
+        secs = secs % 60;
+        if (mins > 0) {
+            return std::to_string(mins) + ":" + (secs < 10 ? "0" : "") + std::to_string(secs);
+        }
+        return std::to_string(secs) + "s";
+    });
+    stats->addEmptyLine();
+    stats->addValue(" # Bullets on screen", [g]() { return std::to_string(g->bulletCount()); });
+    stats->addValue(" # Enemies remaining", [g]() { return std::to_string(g->enemyCount()); });
+    statsFrame.addWidget(std::move(stats));
+
+    class GameWidget : public ui::Widget {
+    public:
+        explicit GameWidget(game::Game* game) : m_game(game) {}
+        void draw(tui::Screen& screen, ui::BBox bbox) override {
+            if (m_game) m_game->draw(screen, bbox);
+        }
+    private:
+        game::Game* m_game;
+    };
+
+    gameFrame.addWidget(std::make_unique<GameWidget>(&m_game));
+}
+
+void Application::setupMenu() {
+    m_menu.addEntry("Menu:", false, nullptr);
+    m_menu.addSeparator();
+    m_menu.addEntry("Continue", true, [this]() {
+        if (m_game.status() == game::GameStatus::Paused) {
+            m_game.setStatus(game::GameStatus::Running);
+        }
+        m_currentScreen = ScreenType::Game;
+    });
+    m_menu.addEntry("New Game", true, [this]() {
+        startNewGame();
+    });
+    m_menu.addEntry("Quit", true, [this]() {
+        m_running = false;
+    });
+
+    m_menu.moveDown();
+
+    m_gameOverMenu.addEntry("Game Over!", false, nullptr);
+    m_gameOverMenu.addSeparator();
+    m_gameOverMenu.addEntry("New Game", true, [this]() {
+        startNewGame();
+    });
+    m_gameOverMenu.addEntry("Quit", true, [this]() {
+        m_running = false;
+    });
+
+    m_gameOverMenu.moveDown();
+
+    m_winMenu.addEntry("You Win!", false, nullptr);
+    m_winMenu.addSeparator();
+    m_winMenu.addEntry("New Game", true, [this]() {
+        startNewGame();
+    });
+    m_winMenu.addEntry("Quit", true, [this]() {
+        m_running = false;
+    });
+
+    m_winMenu.moveDown();
+}
+
+void Application::startNewGame() {
+    m_game.reset();
+    game::spawnLevel(m_game, game::LEVELS[0]);
+    m_currentScreen = ScreenType::Game;
+}
+
+void Application::processInput(const input::Event& ev) {
+    auto* keyEv = std::get_if<input::KeyEvent>(&ev);
+    if (!keyEv) return;
+
+    if (keyEv->isChar('q') || keyEv->isChar('Q')) {
+        m_running = false;
+        return;
+    }
+
+    switch (m_currentScreen) {
+    case ScreenType::Game:
+        if (keyEv->isChar('m') || keyEv->isChar('M')) {
+            m_game.setStatus(game::GameStatus::Paused);
+            m_currentScreen = ScreenType::Menu;
+            return;
+        }
+        m_game.processInput(ev);
+        break;
+
+    case ScreenType::Menu:
+        if (keyEv->isKey(input::KeyCode::Up)) {
+            for (int i = 0; i < keyEv->count; i++) m_menu.moveUp();
+        } else if (keyEv->isKey(input::KeyCode::Down)) {
+            for (int i = 0; i < keyEv->count; i++) m_menu.moveDown();
+        } else if (keyEv->isKey(input::KeyCode::Enter)) {
+            m_menu.select();
+        }
+        break;
+
+    case ScreenType::GameOver:
+        if (keyEv->isKey(input::KeyCode::Up)) {
+            for (int i = 0; i < keyEv->count; i++) m_gameOverMenu.moveUp();
+        } else if (keyEv->isKey(input::KeyCode::Down)) {
+            for (int i = 0; i < keyEv->count; i++) m_gameOverMenu.moveDown();
+        } else if (keyEv->isKey(input::KeyCode::Enter)) {
+            m_gameOverMenu.select();
+        }
+        break;
+
+    case ScreenType::Win:
+        if (keyEv->isKey(input::KeyCode::Up)) {
+            for (int i = 0; i < keyEv->count; i++) m_winMenu.moveUp();
+        } else if (keyEv->isKey(input::KeyCode::Down)) {
+            for (int i = 0; i < keyEv->count; i++) m_winMenu.moveDown();
+        } else if (keyEv->isKey(input::KeyCode::Enter)) {
+            m_winMenu.select();
+        }
+        break;
+    }
+}
+
+void Application::inputLoop() {
+    // Sleeps in wait() until the terminal has input or run() is done, and
+    // touches nothing but m_input and the queue. Each wakeup queues every
+    // event of one read.
+    std::array<input::Event, 64> batch;
+    while (m_running) {
+        if (!m_input.wait()) continue;
+
+        size_t count = m_input.pollAll(batch.data(), batch.size());
+        i64 now = time_us();
+        for (size_t i = 0; i < count; i++) {
+            if (!m_events.push({std::move(batch[i]), now})) m_droppedEvents++;
+        }
+    }
+}
+
+void Application::applyQueuedInput() {
+    input::TimedEvent queued;
+    m_pending.clear();
+    while (m_events.pop(queued)) {
+        i64 wait = time_us() - queued.time;
+        m_queueStats.events++;
+        m_queueStats.totalWaitUs += wait;
+        m_queueStats.maxWaitUs = std::max(m_queueStats.maxWaitUs, wait);
+        m_pending.push_back(std::move(queued.event));
+    }
+    applyInput(m_pending);
+}
+
+void Application::applyInput(std::vector<input::Event>& events) {
+    size_t count = input::coalesce(events.data(), events.size());
+    m_queueStats.coalesced += events.size() - count;
+
+    for (size_t i = 0; i < count; i++) {
+        if (auto* key = std::get_if<input::KeyEvent>(&events[i])) {
+            // Releases only matter to the held keys, and held game controls
+            // are applied by sampleHeldKeys()
+            if (key->action == input::KeyAction::Release) continue;
+            if (m_sampleHeldKeys && m_currentScreen == ScreenType::Game &&
+                game::Game::isHeldKey(*key)) {
+                continue;
+            }
+        }
+        applyEvent(events[i]);
+    }
+
+    if (m_sampleHeldKeys) sampleHeldKeys();
+}
+
+void Application::sampleHeldKeys() {
+    // Sampled on every screen, so keys pressed in a menu do not act once
+    // the game is back. Each one becomes a plain key press, which keeps
+    // recordings the same as on other terminals.
+    for (input::KeyCode code : game::Game::HELD_KEYS) {
+        if (!m_input.heldKeys().sample(code) || m_currentScreen != ScreenType::Game) continue;
+
+        input::KeyEvent key;
+        key.key = code;
+        if (static_cast<u16>(code) < 128) key.ch[0] = static_cast<char>(code);
+        applyEvent(key);
+    }
+}
+
+void Application::applyEvent(const input::Event& ev) {
+    // Recorded with the tick count it is applied after, which is where
+    // replay() applies it too
+    if (m_recorder) m_recorder->add(m_tickCount, ev);
+    processInput(ev);
+}
+
+InputQueueStats Application::inputQueueStats() const {
+    InputQueueStats stats = m_queueStats;
+    stats.dropped = m_droppedEvents.load();
+    return stats;
+}
+
+void Application::setMouseInterest(ScreenType screen, bool interested) {
+    m_mouseInterest[static_cast<size_t>(screen)] = interested;
+}
+
+void Application::draw() {
+    m_screen.clear();
+    m_screen.setMouseTracking(m_mouseInterest[static_cast<size_t>(m_currentScreen)]);
+
+    switch (m_currentScreen) {
+    case ScreenType::Game:
+        m_rootFrame.draw(m_screen);
+        break;
+    case ScreenType::Menu:
+        m_menu.draw(m_screen);
+        break;
+    case ScreenType::GameOver:
+        m_gameOverMenu.draw(m_screen);
+        break;
+    case ScreenType::Win:
+        m_winMenu.draw(m_screen);
+        break;
+    }
+}
+
+void Application::render() {
+    draw();
+    m_screen.flush();
+}
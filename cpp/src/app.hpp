@@ -0,0 +1,117 @@
+#pragma once
+
+#include "common.hpp"
+#include "tui/screen.hpp"
+#include "input/input.hpp"
+#include "input/queue.hpp"
+#include "input/replay.hpp"
+#include "ui/frame.hpp"
+#include "ui/menu.hpp"
+#include "game/game.hpp"
+
+#include <atomic>
+
+enum class ScreenType {
+    Game,
+    Menu,
+    GameOver,
+    Win
+};
+
+// How long events waited between the input thread and the tick that
+// applied them
+struct InputQueueStats {
+    u64 events = 0;
+    u64 dropped = 0;    // lost to a full queue
+    u64 coalesced = 0;  // merged into another event by input::coalesce()
+    i64 totalWaitUs = 0;
+    i64 maxWaitUs = 0;
+};
+
+class Application {
+public:
+    static constexpr int TICKS_PER_SECOND = 4;
+    static constexpr u64 KEYFRAME_INTERVAL = 40;  // ticks between recorded keyframes
+    static constexpr size_t INPUT_QUEUE_CAPACITY = 1024;
+
+    // Runs on the controlling terminal unless given another backend
+    explicit Application(std::unique_ptr<tui::Backend> backend = std::make_unique<tui::TtyBackend>());
+
+    // Real-time loop until quit. The input thread only parses events and
+    // queues them; each tick first applies the queued events, then updates
+    // the game and renders. On terminals that report key releases the game
+    // controls (Game::HELD_KEYS) are sampled from the held keys once per
+    // tick instead, so holding one acts every tick.
+    void run();
+
+    // Records every input event run() applies, with its tick, and a
+    // keyframe every KEYFRAME_INTERVAL ticks
+    void setRecorder(std::unique_ptr<input::Recorder> recorder) { m_recorder = std::move(recorder); }
+
+    // Plays a recorded session back, applying each event before the tick it
+    // was recorded on. Real time keeps the game period between ticks,
+    // otherwise ticks run back to back. The keyboard only controls the
+    // playback: left/right jump to the previous/next keyframe, space
+    // pauses, 'q' stops. Playback holds on the last recorded tick, where it
+    // can still be rewound, until 'q'.
+    void replay(const input::Replay& replay, bool realTime);
+
+    // Mouse reports are only requested from the terminal while a screen
+    // that registered interest is shown; none does by default
+    void setMouseInterest(ScreenType screen, bool interested);
+
+    // Screen, menu selections and game state as a flat list of values
+    // (replay keyframes); loadState() restores it
+    void saveState(std::vector<i64>& out) const;
+    void loadState(const std::vector<i64>& state);
+
+    // The pieces run() is made of, for driving the app without threads.
+    // applyInput() takes the events of one tick and applies them like
+    // run() does: coalesced, recorded, with held keys sampled; the events
+    // are modified in place.
+    void applyInput(std::vector<input::Event>& events);
+    void tick(i64 deltaTime);
+    void processInput(const input::Event& ev);
+    void draw();    // current screen into the back buffer
+    void render();  // draw() and flush
+
+    bool running() const { return m_running; }
+    u64 tickCount() const { return m_tickCount; }
+    ScreenType currentScreen() const { return m_currentScreen; }
+    InputQueueStats inputQueueStats() const;
+    tui::Screen& screen() { return m_screen; }
+    game::Game& game() { return m_game; }
+
+private:
+    void setupGame();
+    void setupLayout();
+    void setupMenu();
+    void startNewGame();
+    void inputLoop();
+    void applyQueuedInput();
+    void sampleHeldKeys();
+    void applyEvent(const input::Event& ev);
+    void drawReplayStatus(u64 totalTicks, const char* state);
+
+    std::atomic<bool> m_running{true};
+    u64 m_tickCount = 0;  // tick() calls so far
+    std::unique_ptr<input::Recorder> m_recorder;
+
+    tui::Screen m_screen;
+    input::InputHandler m_input;
+    input::SpscQueue<input::TimedEvent, INPUT_QUEUE_CAPACITY> m_events;  // input thread -> run()
+    std::atomic<u64> m_droppedEvents{0};
+    InputQueueStats m_queueStats;        // updated by applyQueuedInput()
+    std::vector<input::Event> m_pending;  // events of the current tick
+    bool m_sampleHeldKeys = false;         // the backend reports key releases
+
+    std::array<bool, 4> m_mouseInterest = {};  // by ScreenType
+
+    game::Game m_game;
+    ui::Frame m_rootFrame;
+    ui::Menu m_menu;
+    ui::Menu m_gameOverMenu;
+    ui::Menu m_winMenu;
+
+    ScreenType m_currentScreen = ScreenType::Game;
+};
@@ -0,0 +1,339 @@
+#include "benchmark.hpp"
+#include "app.hpp"
+#include "alloc.hpp"
+#include "scenario.hpp"
+#include "game/level.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <sys/resource.h>
+
+namespace benchmark {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int STRESS_BULLETS = 4000;
+constexpr int PLAYER_HEALTH = 1'000'000;  // scenarios run the full tick count
+
+input::Event key(input::KeyCode code) {
+    input::KeyEvent ev;
+    ev.key = code;
+    return ev;
+}
+
+input::Event key(char c) {
+    input::KeyEvent ev;
+    ev.key = static_cast<input::KeyCode>(c);
+    ev.ch[0] = c;
+    return ev;
+}
+
+// Scripted input for one tick, appended to events
+using Script = void (*)(Application& app, std::mt19937& rng, int tick,
+                        std::vector<input::Event>& events);
+using Setup = void (*)(Application& app, std::mt19937& rng);
+
+struct Scenario {
+    const char* name;
+    const char* description;
+    Setup setup;
+    Script script;
+};
+
+void keepPlayerAlive(Application& app, std::mt19937&) {
+    if (app.game().player()) app.game().player()->setHealth(PLAYER_HEALTH);
+}
+
+void dodge(Application&, std::mt19937& rng, int, std::vector<input::Event>& events) {
+    switch (rng() % 4) {
+    case 0: events.push_back(key('a')); break;
+    case 1: events.push_back(key('d')); break;
+    default: break;
+    }
+}
+
+void setupLevel3(Application& app, std::mt19937& rng) {
+    game::Game& g = app.game();
+    g.enemies().clear();
+    g.setLevel(3);
+    game::spawnLevel(g, game::LEVELS[2]);
+    keepPlayerAlive(app, rng);
+}
+
+// Game -> menu, move the selection down and back, continue
+void toggleMenu(Application&, std::mt19937&, int tick, std::vector<input::Event>& events) {
+    switch (tick % 8) {
+    case 0: events.push_back(key('m')); break;
+    case 2: events.push_back(key(input::KeyCode::Down)); break;
+    case 4: events.push_back(key(input::KeyCode::Up)); break;
+    case 6: events.push_back(key(input::KeyCode::Enter)); break;
+    default: break;
+    }
+}
+
+// Tops the field up with enemy bullets at random cells every tick
+void flood(Application& app, std::mt19937& rng, int tick, std::vector<input::Event>& events) {
+    game::Game& g = app.game();
+    while (g.bulletCount() < STRESS_BULLETS) {
+        int x = static_cast<int>(rng() % g.bounds().w);
+        int y = static_cast<int>(rng() % g.bounds().h);
+        g.spawnBullet(x, y, 1, game::EntityType::Enemy).setShape("|");
+    }
+    dodge(app, rng, tick, events);
+}
+
+const Scenario SCENARIOS[] = {
+    {"idle", "game screen, no input", nullptr, nullptr},
+    {"level3", "level 3, player dodging enemy fire", setupLevel3, dodge},
+    {"menu", "toggling between the game and the menu", keepPlayerAlive, toggleMenu},
+    {"stress", "4000 enemy bullets kept on the field", keepPlayerAlive, flood},
+};
+
+struct Latency {
+    std::vector<i64> samples;  // ns
+
+    void add(Clock::duration d) {
+        samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    }
+
+    double percentile(double p) {
+        if (samples.empty()) return 0;
+        size_t i = static_cast<size_t>(p * (samples.size() - 1));
+        std::nth_element(samples.begin(), samples.begin() + i, samples.end());
+        return samples[i] / 1000.0;
+    }
+
+    double max() const {
+        return samples.empty() ? 0 : *std::max_element(samples.begin(), samples.end()) / 1000.0;
+    }
+};
+
+void printLatency(const char* name, Latency& l) {
+    std::printf("  %-8s %10.1f %10.1f %10.1f\n", name,
+                l.percentile(0.50), l.percentile(0.99), l.max());
+}
+
+bool writeTrace(const char* path, const std::vector<u64>& hashes) {
+    FILE* f = std::fopen(path, "w");
+    if (!f) {
+        std::fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    for (u64 h : hashes) {
+        std::fprintf(f, "%016llx\n", static_cast<unsigned long long>(h));
+    }
+    return std::fclose(f) == 0;
+}
+
+bool parseInt(const char* s, int& out) {
+    char* end;
+    long v = std::strtol(s, &end, 10);
+    if (end == s || *end != '\0' || v <= 0) return false;
+    out = static_cast<int>(v);
+    return true;
+}
+
+} // namespace
+
+bool parseArgs(int argc, char** argv, Options& options) {
+    if (argc < 3 || std::strcmp(argv[1], "--bench") != 0) return false;
+    options.scenario = argv[2];
+
+    if ((argc - 3) % 2 != 0) return false;
+
+    for (int i = 3; i < argc; i += 2) {
+        const char* flag = argv[i];
+        const char* value = argv[i + 1];
+        int seed;
+
+        if (std::strcmp(flag, "--ticks") == 0) {
+            if (!parseInt(value, options.ticks)) return false;
+        } else if (std::strcmp(flag, "--size") == 0) {
+            if (std::sscanf(value, "%dx%d", &options.width, &options.height) != 2 ||
+                options.width <= 0 || options.height <= 0) {
+                return false;
+            }
+        } else if (std::strcmp(flag, "--seed") == 0) {
+            if (!parseInt(value, seed)) return false;
+            options.seed = static_cast<u32>(seed);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+int run(const Options& options) {
+    const Scenario* scenario = nullptr;
+    for (const auto& s : SCENARIOS) {
+        if (options.scenario == s.name) scenario = &s;
+    }
+    if (!scenario) {
+        std::fprintf(stderr, "unknown scenario '%s', expected one of:\n", options.scenario.c_str());
+        for (const auto& s : SCENARIOS) {
+            std::fprintf(stderr, "  %-8s %s\n", s.name, s.description);
+        }
+        return 2;
+    }
+
+    Application app(std::make_unique<tui::NullBackend>(options.width, options.height));
+    std::mt19937 rng(options.seed);
+    if (scenario->setup) scenario->setup(app, rng);
+
+    const i64 dt = US_PER_SEC / app.game().tps();
+    Latency tickTime, drawTime, flushTime;
+    tickTime.samples.reserve(options.ticks);
+    drawTime.samples.reserve(options.ticks);
+    flushTime.samples.reserve(options.ticks);
+    std::vector<input::Event> events;
+
+    // Like Application::run(): the events of a tick applied together, then
+    // the tick and one render
+    auto render = [&]() {
+        auto t0 = Clock::now();
+        app.draw();
+        auto t1 = Clock::now();
+        app.screen().flush();
+        auto t2 = Clock::now();
+        drawTime.add(t1 - t0);
+        flushTime.add(t2 - t1);
+    };
+
+    // The first frame draws everything; it is not part of the steady state
+    render();
+    drawTime.samples.clear();
+    flushTime.samples.clear();
+
+    u64 allocsBefore = alloc::count();
+    u64 bytesBefore = app.screen().stats().bytes;
+    auto start = Clock::now();
+
+    int ticks = 0;
+    for (; ticks < options.ticks && app.running(); ticks++) {
+        events.clear();
+        if (scenario->script) scenario->script(app, rng, ticks, events);
+        app.applyInput(events);
+
+        auto t0 = Clock::now();
+        app.tick(dt);
+        tickTime.add(Clock::now() - t0);
+        render();
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    u64 allocs = alloc::count() - allocsBefore;
+    u64 bytes = app.screen().stats().bytes - bytesBefore;
+    size_t frames = flushTime.samples.size();
+
+    std::printf("scenario %s: %s\n", scenario->name, scenario->description);
+    std::printf("  %dx%d, seed %u, %d ticks, %zu frames, %.3f s\n",
+                options.width, options.height, options.seed, ticks, frames, seconds);
+    std::printf("  ticks/s  %10.1f\n", ticks / seconds);
+    std::printf("  frames/s %10.1f\n", frames / seconds);
+    std::printf("  %-8s %10s %10s %10s\n", "us", "p50", "p99", "max");
+    printLatency("tick", tickTime);
+    printLatency("draw", drawTime);
+    printLatency("flush", flushTime);
+    std::printf("  bytes    %10llu (%.1f per frame)\n",
+                static_cast<unsigned long long>(bytes), frames ? double(bytes) / frames : 0.0);
+    std::printf("  allocs   %10llu (%.1f per tick)\n",
+                static_cast<unsigned long long>(allocs), ticks ? double(allocs) / ticks : 0.0);
+    return 0;
+}
+
+int runScenario(const std::string& path, const char* tracePath) {
+    scenario::Script script;
+    try {
+        script = scenario::Script::load(path);
+    } catch (const std::runtime_error& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+
+    Application app(std::make_unique<tui::NullBackend>(script.width, script.height));
+    game::Game& g = app.game();
+    g.setLevel(script.level);
+    if (script.level > 1) {
+        g.enemies().clear();
+        game::spawnLevel(g, game::LEVELS[script.level - 1]);
+    }
+    if (script.health > 0 && g.player()) g.player()->setHealth(script.health);
+
+    const i64 dt = US_PER_SEC / g.tps();
+    Latency tickTime, flushTime;
+    tickTime.samples.reserve(script.ticks);
+    flushTime.samples.reserve(script.ticks * 17);
+    std::vector<input::Event> events;
+    events.reserve(16);
+    std::vector<u64> trace;
+    trace.reserve(script.ticks + 1);
+    trace.push_back(g.stateHash());
+    u32 rng = script.seed;
+
+    auto render = [&]() {
+        app.draw();
+        auto t0 = Clock::now();
+        app.screen().flush();
+        flushTime.add(Clock::now() - t0);
+    };
+
+    // The first frame draws everything; it is not part of the steady state
+    app.render();
+
+    u64 allocsBefore = alloc::count();
+    u64 bytesBefore = app.screen().stats().bytes;
+
+    // Same order as game-c, which renders after every event and every
+    // tick. Application::run() renders once per tick instead, so frames,
+    // bytes and flush times here are those of the per-event loop; the
+    // trace is the same either way.
+    int ticks = 0;
+    for (; ticks < script.ticks && app.running(); ticks++) {
+        events.clear();
+        script.events(ticks, rng, events);
+        for (const auto& ev : events) {
+            app.processInput(ev);
+            render();
+        }
+
+        auto t0 = Clock::now();
+        app.tick(dt);
+        tickTime.add(Clock::now() - t0);
+        trace.push_back(g.stateHash());
+        render();
+    }
+
+    u64 allocs = alloc::count() - allocsBefore;
+    u64 bytes = app.screen().stats().bytes - bytesBefore;
+    size_t frames = flushTime.samples.size();
+
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+
+    std::printf("{\n");
+    std::printf("  \"lang\": \"cpp\",\n");
+    std::printf("  \"scenario\": \"%s\",\n", script.name.c_str());
+    std::printf("  \"ticks\": %d,\n", ticks);
+    std::printf("  \"frames\": %zu,\n", frames);
+    std::printf("  \"tick_p50_us\": %.3f,\n", tickTime.percentile(0.50));
+    std::printf("  \"tick_p99_us\": %.3f,\n", tickTime.percentile(0.99));
+    std::printf("  \"tick_max_us\": %.3f,\n", tickTime.max());
+    std::printf("  \"flush_p50_us\": %.3f,\n", flushTime.percentile(0.50));
+    std::printf("  \"flush_p99_us\": %.3f,\n", flushTime.percentile(0.99));
+    std::printf("  \"flush_max_us\": %.3f,\n", flushTime.max());
+    std::printf("  \"bytes_written\": %llu,\n", static_cast<unsigned long long>(bytes));
+    std::printf("  \"max_rss_kb\": %ld,\n", usage.ru_maxrss);
+    std::printf("  \"allocations\": %llu\n", static_cast<unsigned long long>(allocs));
+    std::printf("}\n");
+
+    if (tracePath && !writeTrace(tracePath, trace)) return 1;
+    return 0;
+}
+
+} // namespace benchmark
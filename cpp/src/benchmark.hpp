@@ -0,0 +1,30 @@
+#pragma once
+
+#include "common.hpp"
+
+// Headless benchmark mode (game-cpp --bench <scenario>): drives the real
+// Application, game and Screen code on a null backend with scripted input
+namespace benchmark {
+
+struct Options {
+    std::string scenario;
+    int ticks = 2000;
+    int width = 120;
+    int height = 40;
+    u32 seed = 1;
+};
+
+// Parses "--bench <scenario> [--ticks N] [--size WxH] [--seed N]"
+// starting at argv[1]; false if the arguments are malformed
+bool parseArgs(int argc, char** argv, Options& options);
+
+// Runs the scenario and prints its report; returns the process exit code
+int run(const Options& options);
+
+// Runs a scenario file (game-cpp --scenario <file>, see scenario.hpp) and
+// prints the metrics as JSON with the same keys as game-c --scenario. With
+// a trace path, also writes Game::stateHash() after setup and after every
+// tick, one hex value per line, in the same format as game-c.
+int runScenario(const std::string& path, const char* tracePath = nullptr);
+
+} // namespace benchmark
@@ -14,6 +14,33 @@ void Entity::draw(tui::Screen& screen, int x, int y) const {
     screen.setFgColor(x, y, fg);
 }
 
+u64 Entity::stateHash() const {
+    u64 h = STATE_HASH_SEED;
+    h = stateHashAdd(h, static_cast<i64>(m_type));
+    h = stateHashAdd(h, m_x);
+    h = stateHashAdd(h, m_y);
+    h = stateHashAdd(h, m_alive);
+    h = stateHashAdd(h, static_cast<i64>(m_color));
+    h = stateHashAdd(h, m_shape.empty() ? 0 : static_cast<unsigned char>(m_shape[0]));
+    return h;
+}
+
+void Entity::saveState(std::vector<i64>& out) const {
+    out.insert(out.end(), {
+        m_x, m_y, m_alive, static_cast<i64>(m_color),
+        m_shape.empty() ? 0 : static_cast<unsigned char>(m_shape[0]),
+    });
+}
+
+void Entity::loadState(StateReader& in) {
+    m_x = in.nextInt();
+    m_y = in.nextInt();
+    m_alive = in.next() != 0;
+    m_color = static_cast<EntityColor>(in.next());
+    char shape = static_cast<char>(in.next());
+    m_shape = shape ? std::string(1, shape) : std::string();
+}
+
 bool collision(const Entity& a, const Entity& b) {
     return a.x() == b.x() && a.y() == b.y();
 }
@@ -48,6 +75,30 @@ void Player::update() {
     }
 }
 
+u64 Player::stateHash() const {
+    u64 h = Entity::stateHash();
+    h = stateHashAdd(h, m_health);
+    h = stateHashAdd(h, m_damage);
+    h = stateHashAdd(h, m_cooldown);
+    h = stateHashAdd(h, m_ticks);
+    h = stateHashAdd(h, m_damaged);
+    return h;
+}
+
+void Player::saveState(std::vector<i64>& out) const {
+    Entity::saveState(out);
+    out.insert(out.end(), {m_health, m_damage, m_cooldown, m_ticks, m_damaged});
+}
+
+void Player::loadState(StateReader& in) {
+    Entity::loadState(in);
+    m_health = in.nextInt();
+    m_damage = in.nextInt();
+    m_cooldown = in.nextInt();
+    m_ticks = in.nextInt();
+    m_damaged = in.next() != 0;
+}
+
 Enemy::Enemy(int x, int y, int health, int score, int fireFreq, int dmg)
     : Entity(x, y, EntityType::Enemy, "V")
     , m_health(health)
@@ -84,6 +135,30 @@ void Enemy::update() {
     }
 }
 
+u64 Enemy::stateHash() const {
+    u64 h = Entity::stateHash();
+    h = stateHashAdd(h, m_health);
+    h = stateHashAdd(h, m_score);
+    h = stateHashAdd(h, m_fireFreq);
+    h = stateHashAdd(h, m_lastFired);
+    h = stateHashAdd(h, m_damage);
+    return h;
+}
+
+void Enemy::saveState(std::vector<i64>& out) const {
+    Entity::saveState(out);
+    out.insert(out.end(), {m_health, m_score, m_fireFreq, m_lastFired, m_damage});
+}
+
+void Enemy::loadState(StateReader& in) {
+    Entity::loadState(in);
+    m_health = in.nextInt();
+    m_score = in.nextInt();
+    m_fireFreq = in.nextInt();
+    m_lastFired = in.nextInt();
+    m_damage = in.nextInt();
+}
+
 Bullet::Bullet(int x, int y, int dmg, EntityType owner)
     : Entity(x, y, EntityType::Bullet, "0")
     , m_owner(owner)
@@ -138,4 +213,26 @@ void Bullet::update() {
     }
 }
 
+u64 Bullet::stateHash() const {
+    u64 h = Entity::stateHash();
+    h = stateHashAdd(h, static_cast<i64>(m_owner));
+    h = stateHashAdd(h, m_damage);
+    h = stateHashAdd(h, m_moveFreq);
+    h = stateHashAdd(h, m_lastMoved);
+    return h;
+}
+
+void Bullet::saveState(std::vector<i64>& out) const {
+    Entity::saveState(out);
+    out.insert(out.end(), {static_cast<i64>(m_owner), m_damage, m_moveFreq, m_lastMoved});
+}
+
+void Bullet::loadState(StateReader& in) {
+    Entity::loadState(in);
+    m_owner = static_cast<EntityType>(in.next());
+    m_damage = in.nextInt();
+    m_moveFreq = in.nextInt();
+    m_lastMoved = in.nextInt();
+}
+
 } // namespace game
@@ -32,6 +32,32 @@ inline tui::Color toScreenColor(EntityColor c) {
     }
 }
 
+// State hashing, shared with the C version: values are folded one at a
+// time through the splitmix64 finalizer, so both produce the same hash for
+// the same state
+inline constexpr u64 STATE_HASH_SEED = 0xcbf29ce484222325ULL;
+
+inline u64 stateHashAdd(u64 h, i64 v) {
+    u64 x = (h ^ static_cast<u64>(v)) + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Replay keyframes store the simulation as a flat list of values, every
+// field in a fixed order; StateReader walks such a list back
+class StateReader {
+public:
+    explicit StateReader(const std::vector<i64>& words) : m_words(words) {}
+
+    i64 next() { return m_pos < m_words.size() ? m_words[m_pos++] : 0; }
+    int nextInt() { return static_cast<int>(next()); }
+
+private:
+    const std::vector<i64>& m_words;
+    size_t m_pos = 0;
+};
+
 // Forward declaration
 class Game;
 
@@ -44,6 +70,13 @@ public:
     virtual int damage(int amount) { return 0; }
     virtual void update() {}
 
+    // Hash of position and state; subclasses add their own fields
+    virtual u64 stateHash() const;
+
+    // Keyframe state, see StateReader; subclasses append their own fields
+    virtual void saveState(std::vector<i64>& out) const;
+    virtual void loadState(StateReader& in);
+
     // Draw entity at screen coordinates
     void draw(tui::Screen& screen, int x, int y) const;
 
@@ -84,6 +117,9 @@ public:
 
     int damage(int amount) override;
     void update() override;
+    u64 stateHash() const override;
+    void saveState(std::vector<i64>& out) const override;
+    void loadState(StateReader& in) override;
 
     bool canFire() const { return m_ticks >= m_cooldown; }
     void resetFireCooldown() { m_ticks = 0; }
@@ -106,6 +142,9 @@ public:
 
     int damage(int amount) override;
     void update() override;
+    u64 stateHash() const override;
+    void saveState(std::vector<i64>& out) const override;
+    void loadState(StateReader& in) override;
 
     void setGame(Game* game) { m_game = game; }
     int scoreValue() const { return m_score; }
@@ -125,6 +164,9 @@ public:
     Bullet(int x, int y, int dmg, EntityType owner);
 
     void update() override;
+    u64 stateHash() const override;
+    void saveState(std::vector<i64>& out) const override;
+    void loadState(StateReader& in) override;
 
     void setGame(Game* game) { m_game = game; }
     EntityType owner() const { return m_owner; }
@@ -86,20 +86,21 @@ void Game::processInput(const input::Event& ev) {
     auto* keyEv = std::get_if<input::KeyEvent>(&ev);
     if (!keyEv) return;
 
+    // A coalesced key (see input::coalesce) acts once per repeat
     if (keyEv->isChar('a') || keyEv->isChar('A') ||
         keyEv->isKey(input::KeyCode::Left)) {
-        if (m_player && m_player->x() > 0) {
-            m_player->move(-1, 0);
+        if (m_player) {
+            m_player->move(-std::min<int>(keyEv->count, m_player->x()), 0);
         }
     }
     else if (keyEv->isChar('d') || keyEv->isChar('D') ||
              keyEv->isKey(input::KeyCode::Right)) {
-        if (m_player && m_player->x() < m_bounds.w - 1) {
-            m_player->move(1, 0);
+        if (m_player) {
+            m_player->move(std::min<int>(keyEv->count, m_bounds.w - 1 - m_player->x()), 0);
         }
     }
     else if (keyEv->isChar(' ')) {
-        if (m_player && m_player->canFire()) {
+        for (int i = 0; i < keyEv->count && m_player && m_player->canFire(); i++) {
             spawnBullet(m_player->x(), m_player->y() - 1,
                        m_player->attackDamage(), EntityType::Player);
             m_player->resetFireCooldown();
@@ -108,6 +109,80 @@ void Game::processInput(const input::Event& ev) {
     }
 }
 
+bool Game::isHeldKey(const input::KeyEvent& key) {
+    return key.isChar('a') || key.isChar('d') || key.isChar(' ') ||
+           key.isKey(input::KeyCode::Left) || key.isKey(input::KeyCode::Right);
+}
+
+u64 Game::stateHash() const {
+    u64 h = STATE_HASH_SEED;
+    h = stateHashAdd(h, m_bounds.w);
+    h = stateHashAdd(h, m_bounds.h);
+    h = stateHashAdd(h, m_level);
+    h = stateHashAdd(h, m_score);
+    h = stateHashAdd(h, static_cast<i64>(m_status));
+    h = stateHashAdd(h, m_shotsFired);
+    h = stateHashAdd(h, m_shotsHit);
+    h = stateHashAdd(h, m_kills);
+    h = stateHashAdd(h, m_elapsedTime);
+    h = stateHashAdd(h, m_player ? static_cast<i64>(m_player->stateHash()) : 0);
+
+    u64 enemies = 0;
+    for (const auto& e : m_enemies) enemies += e->stateHash();
+    h = stateHashAdd(h, static_cast<i64>(m_enemies.size()));
+    h = stateHashAdd(h, static_cast<i64>(enemies));
+
+    u64 bullets = 0;
+    for (const auto& b : m_bullets) bullets += b->stateHash();
+    h = stateHashAdd(h, static_cast<i64>(m_bullets.size()));
+    h = stateHashAdd(h, static_cast<i64>(bullets));
+
+    return h;
+}
+
+void Game::saveState(std::vector<i64>& out) const {
+    out.insert(out.end(), {
+        m_level, m_score, static_cast<i64>(m_status),
+        m_shotsFired, m_shotsHit, m_kills, m_elapsedTime,
+    });
+
+    out.push_back(m_player != nullptr);
+    if (m_player) m_player->saveState(out);
+
+    out.push_back(static_cast<i64>(m_enemies.size()));
+    for (const auto& e : m_enemies) e->saveState(out);
+
+    out.push_back(static_cast<i64>(m_bullets.size()));
+    for (const auto& b : m_bullets) b->saveState(out);
+}
+
+void Game::loadState(StateReader& in) {
+    m_level = in.nextInt();
+    m_score = in.nextInt();
+    m_status = static_cast<GameStatus>(in.next());
+    m_shotsFired = in.nextInt();
+    m_shotsHit = in.nextInt();
+    m_kills = in.nextInt();
+    m_elapsedTime = in.next();
+
+    if (in.next()) {
+        if (!m_player) spawnPlayer(0, 0, 0, 0, 0);
+        m_player->loadState(in);
+    } else {
+        m_player.reset();
+    }
+
+    m_enemies.clear();
+    for (i64 n = in.next(); n > 0; n--) {
+        spawnEnemy(0, 0, 0, 0, 0, 0).loadState(in);
+    }
+
+    m_bullets.clear();
+    for (i64 n = in.next(); n > 0; n--) {
+        spawnBullet(0, 0, 0, EntityType::Bullet).loadState(in);
+    }
+}
+
 void Game::placeEntitiesOnGrid() {
     m_grid->clearCells();
 
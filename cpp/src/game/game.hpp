@@ -27,9 +27,32 @@ public:
     // Game logic
     void update(i64 deltaTime);
     void processInput(const input::Event& ev);
+
+    // Controls that act for as long as they are held. Where the terminal
+    // reports key releases, the application samples them once per tick
+    // instead of waiting for the terminal's autorepeat.
+    static constexpr std::array<input::KeyCode, 5> HELD_KEYS = {
+        static_cast<input::KeyCode>('a'), static_cast<input::KeyCode>('d'),
+        input::KeyCode::Left, input::KeyCode::Right, static_cast<input::KeyCode>(' '),
+    };
+    static bool isHeldKey(const input::KeyEvent& key);
     void removeDeadEntities();
     void reset();  // Reset game for new game
 
+    // Hash of the simulation state: player, enemies, bullets, score, level,
+    // status and statistics. Enemies and bullets are summed, so their order
+    // does not matter. Matches game_state_hash() in the C version.
+    u64 stateHash() const;
+
+    // Keyframe state (see StateReader). Loading replaces the enemies and
+    // bullets; the Player object is reused when the state has a player and
+    // destroyed when it has none.
+    void saveState(std::vector<i64>& out) const;
+    void loadState(StateReader& in);
+
+    // Points the grid cells at the live entities; the first half of draw()
+    void placeEntitiesOnGrid();
+
     // Entity spawning
     Player& spawnPlayer(int x, int y, int health, int dmg, int cooldown);
     Enemy& spawnEnemy(int x, int y, int health, int score, int fireFreq, int dmg);
@@ -72,8 +95,6 @@ public:
     void incrementKills() { m_kills++; }
 
 private:
-    void placeEntitiesOnGrid();
-
     Bounds m_bounds;
     int m_level = 1;
     int m_score = 0;
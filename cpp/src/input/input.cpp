@@ -1,81 +1,412 @@
 #include "input.hpp"
 #include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
 #include <cstring>
-#include <cstdio>
+#include <stdexcept>
 
 namespace input {
 
-InputHandler::InputHandler() = default;
+InputHandler::InputHandler(int fd)
+    : m_fd(fd), m_wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (m_wakeFd < 0) throw std::runtime_error("Failed to create eventfd");
+}
+
+InputHandler::~InputHandler() {
+    close(m_wakeFd);
+}
+
+bool InputHandler::wait(int timeoutMs) {
+    // Bytes left over from the last read, e.g. several events at once
+    if (remaining() > 0) return true;
+
+    pollfd fds[2] = {
+        {m_wakeFd, POLLIN, 0},
+        {m_hungUp ? -1 : m_fd, POLLIN, 0},  // negative fds are skipped
+    };
+    if (::poll(fds, 2, timeoutMs) <= 0) return false;  // timeout or EINTR
+
+    if (fds[0].revents & POLLIN) {
+        u64 count;  // resets the eventfd
+        [[maybe_unused]] ssize_t n = ::read(m_wakeFd, &count, sizeof(count));
+        return false;
+    }
+    if (fds[1].revents & POLLIN) return true;
+
+    if (fds[1].revents & (POLLHUP | POLLERR | POLLNVAL)) m_hungUp = true;
+    return false;
+}
+
+void InputHandler::wake() {
+    // Fails only when the counter would overflow, i.e. it is already set
+    u64 one = 1;
+    [[maybe_unused]] ssize_t n = ::write(m_wakeFd, &one, sizeof(one));
+}
 
 bool InputHandler::read() {
-    // Shift remaining data to start
-    if (m_pos > 0 && m_pos < m_len) {
-        std::memmove(m_buf.data(), m_buf.data() + m_pos, m_len - m_pos);
-        m_len -= m_pos;
-        m_pos = 0;
-    } else if (m_pos >= m_len) {
-        m_len = 0;
-        m_pos = 0;
+    m_pos = 0;
+    m_len = 0;
+    ssize_t n = ::read(m_fd, m_buf.data(), m_buf.size());
+    if (n > 0) m_len = static_cast<int>(n);
+    return m_len > 0;
+}
+
+namespace {
+
+// Parser states, after the VT500 model minus OSC/DCS, plus UTF-8
+enum State : u8 {
+    GROUND,
+    ESCAPE,
+    CSI_ENTRY,
+    CSI_PARAM,
+    CSI_INTERMEDIATE,
+    CSI_IGNORE,  // malformed CSI, skipped up to its final byte
+    SS3,
+    UTF8,
+    STATE_COUNT
+};
+
+// Byte classes the transitions are defined on
+enum Class : u8 {
+    C_CONTROL,       // C0 controls other than ESC
+    C_ESC,
+    C_INTERMEDIATE,  // 0x20-0x2F
+    C_DIGIT,
+    C_SEPARATOR,     // ; and :
+    C_MARKER,        // < = > ?
+    C_BRACKET,       // [
+    C_O,             // O
+    C_FINAL,         // the rest of 0x40-0x7E
+    C_DEL,
+    C_CONTINUATION,  // UTF-8 0x80-0xBF
+    C_LEAD2,
+    C_LEAD3,
+    C_LEAD4,
+    C_INVALID,       // 0xF8-0xFF
+    CLASS_COUNT
+};
+
+enum Action : u8 {
+    A_NONE,
+    A_CONTROL,    // control character key
+    A_PRINT,      // printable ASCII key
+    A_ESCAPE,     // lone ESC followed by another: the Escape key
+    A_ESC_DISPATCH,
+    A_CSI_CLEAR,
+    A_PARAM,
+    A_MARKER,
+    A_CSI_DISPATCH,
+    A_SS3_DISPATCH,
+    A_UTF8_START,
+    A_UTF8_NEXT,
+};
+
+struct Transition {
+    Action action;
+    State next;
+};
+
+constexpr std::array<Class, 256> makeClasses() {
+    std::array<Class, 256> c{};
+    for (int b = 0; b < 256; b++) {
+        if (b == 0x1B) c[b] = C_ESC;
+        else if (b < 0x20) c[b] = C_CONTROL;
+        else if (b < 0x30) c[b] = C_INTERMEDIATE;
+        else if (b < 0x3A) c[b] = C_DIGIT;
+        else if (b == ';' || b == ':') c[b] = C_SEPARATOR;
+        else if (b < 0x40) c[b] = C_MARKER;
+        else if (b == '[') c[b] = C_BRACKET;
+        else if (b == 'O') c[b] = C_O;
+        else if (b < 0x7F) c[b] = C_FINAL;
+        else if (b == 0x7F) c[b] = C_DEL;
+        else if (b < 0xC0) c[b] = C_CONTINUATION;
+        else if (b < 0xE0) c[b] = C_LEAD2;
+        else if (b < 0xF0) c[b] = C_LEAD3;
+        else if (b < 0xF8) c[b] = C_LEAD4;
+        else c[b] = C_INVALID;
     }
+    return c;
+}
 
-    // Read more data
-    int space = static_cast<int>(m_buf.size()) - m_len;
-    if (space > 0) {
-        int n = ::read(STDIN_FILENO, m_buf.data() + m_len, space);
-        if (n > 0) m_len += n;
+constexpr std::array<std::array<Transition, CLASS_COUNT>, STATE_COUNT> makeTransitions() {
+    std::array<std::array<Transition, CLASS_COUNT>, STATE_COUNT> t{};
+
+    // Ground: keys, the start of escape sequences and UTF-8 characters.
+    // UTF8 behaves the same except for continuation bytes, so a broken
+    // character is dropped and the byte after it still counts.
+    for (State s : {GROUND, UTF8}) {
+        auto& row = t[s];
+        for (int c = 0; c < CLASS_COUNT; c++) row[c] = {A_PRINT, GROUND};
+        row[C_CONTROL] = {A_CONTROL, GROUND};
+        row[C_DEL] = {A_CONTROL, GROUND};
+        row[C_ESC] = {A_NONE, ESCAPE};
+        row[C_CONTINUATION] = {A_NONE, GROUND};
+        row[C_LEAD2] = row[C_LEAD3] = row[C_LEAD4] = {A_UTF8_START, UTF8};
+        row[C_INVALID] = {A_NONE, GROUND};
+    }
+    t[UTF8][C_CONTINUATION] = {A_UTF8_NEXT, UTF8};
+
+    // After ESC: CSI, SS3 or an Alt-modified key
+    for (int c = 0; c < CLASS_COUNT; c++) t[ESCAPE][c] = {A_ESC_DISPATCH, GROUND};
+    t[ESCAPE][C_ESC] = {A_ESCAPE, ESCAPE};
+    t[ESCAPE][C_BRACKET] = {A_CSI_CLEAR, CSI_ENTRY};
+    t[ESCAPE][C_O] = {A_NONE, SS3};
+
+    // CSI: any ESC restarts, controls are dropped, bytes outside the
+    // grammar make the rest of the sequence ignored
+    for (State s : {CSI_ENTRY, CSI_PARAM, CSI_INTERMEDIATE, CSI_IGNORE}) {
+        auto& row = t[s];
+        for (int c = 0; c < CLASS_COUNT; c++) row[c] = {A_NONE, CSI_IGNORE};
+        row[C_ESC] = {A_NONE, ESCAPE};
+        row[C_CONTROL] = row[C_DEL] = {A_NONE, s};
+        row[C_INTERMEDIATE] = {A_NONE, s == CSI_IGNORE ? CSI_IGNORE : CSI_INTERMEDIATE};
+        Action final = s == CSI_IGNORE ? A_NONE : A_CSI_DISPATCH;
+        row[C_FINAL] = row[C_BRACKET] = row[C_O] = {final, GROUND};
     }
+    t[CSI_ENTRY][C_DIGIT] = t[CSI_ENTRY][C_SEPARATOR] = {A_PARAM, CSI_PARAM};
+    t[CSI_ENTRY][C_MARKER] = {A_MARKER, CSI_PARAM};
+    t[CSI_PARAM][C_DIGIT] = t[CSI_PARAM][C_SEPARATOR] = {A_PARAM, CSI_PARAM};
+
+    // SS3: one final byte
+    for (int c = 0; c < CLASS_COUNT; c++) t[SS3][c] = {A_NONE, GROUND};
+    t[SS3][C_ESC] = {A_NONE, ESCAPE};
+    t[SS3][C_FINAL] = t[SS3][C_O] = t[SS3][C_BRACKET] = {A_SS3_DISPATCH, GROUND};
+    return t;
+}
+
+constexpr auto CLASSES = makeClasses();
+constexpr auto TRANSITIONS = makeTransitions();
 
-    return m_len - m_pos > 0;
+KeyEvent charKey(char c, u8 mods = MOD_NONE) {
+    KeyEvent key;
+    key.key = static_cast<KeyCode>(c);
+    key.mods = mods;
+    key.ch[0] = c;
+    return key;
 }
 
-bool InputHandler::match(const char* seq, int len) const {
-    if (m_pos + len > m_len) return false;
-    return std::memcmp(m_buf.data() + m_pos, seq, len) == 0;
+KeyEvent specialKey(KeyCode code, u8 mods = MOD_NONE) {
+    KeyEvent key;
+    key.key = code;
+    key.mods = mods;
+    return key;
 }
 
-void InputHandler::consume(int n) {
-    m_pos += n;
+// Modifiers of a CSI key from its "1 + bits" parameter
+u8 csiMods(int param) {
+    if (param <= 1) return MOD_NONE;
+    int mod = param - 1;
+    u8 mods = MOD_NONE;
+    if (mod & MOD_SHIFT) mods |= MOD_SHIFT;
+    if (mod & MOD_ALT) mods |= MOD_ALT;
+    if (mod & MOD_CTRL) mods |= MOD_CTRL;
+    return mods;
 }
 
-int InputHandler::remaining() const {
-    return m_len - m_pos;
+KeyCode tildeKey(int param) {
+    switch (param) {
+        case 1:  return KeyCode::Home;
+        case 2:  return KeyCode::Insert;
+        case 3:  return KeyCode::Delete;
+        case 4:  return KeyCode::End;
+        case 5:  return KeyCode::PageUp;
+        case 6:  return KeyCode::PageDown;
+        case 11: return KeyCode::F1;
+        case 12: return KeyCode::F2;
+        case 13: return KeyCode::F3;
+        case 14: return KeyCode::F4;
+        case 15: return KeyCode::F5;
+        case 17: return KeyCode::F6;
+        case 18: return KeyCode::F7;
+        case 19: return KeyCode::F8;
+        case 20: return KeyCode::F9;
+        case 21: return KeyCode::F10;
+        case 23: return KeyCode::F11;
+        case 24: return KeyCode::F12;
+        default: return KeyCode::None;
+    }
 }
 
-char InputHandler::peek(int offset) const {
-    int idx = m_pos + offset;
-    if (idx < 0 || idx >= m_len) return 0;
-    return m_buf[idx];
+// Keys sent as CSI or SS3 with a letter
+KeyCode cursorKey(u8 final) {
+    switch (final) {
+        case 'A': return KeyCode::Up;
+        case 'B': return KeyCode::Down;
+        case 'C': return KeyCode::Right;
+        case 'D': return KeyCode::Left;
+        case 'H': return KeyCode::Home;
+        case 'F': return KeyCode::End;
+        case 'P': return KeyCode::F1;
+        case 'Q': return KeyCode::F2;
+        case 'R': return KeyCode::F3;
+        case 'S': return KeyCode::F4;
+        default:  return KeyCode::None;
+    }
 }
 
-bool InputHandler::parseMouseSgr(Event& ev) {
-    if (!match("\x1b[<", 3)) return false;
+// Event type sub-parameter of the kitty keyboard protocol's modifiers
+KeyAction keyAction(int subParam) {
+    switch (subParam) {
+        case 2:  return KeyAction::Repeat;
+        case 3:  return KeyAction::Release;
+        default: return KeyAction::Press;
+    }
+}
 
-    int end = -1;
-    for (int i = 3; i < remaining(); i++) {
-        char c = peek(i);
-        if (c == 'M' || c == 'm') {
-            end = i;
-            break;
+} // namespace
+
+bool InputHandler::advance(u8 byte, Event& ev) {
+    Transition t = TRANSITIONS[m_state][CLASSES[byte]];
+    m_state = t.next;
+
+    switch (t.action) {
+    case A_NONE:
+        return false;
+    case A_CONTROL:
+        return dispatchControl(byte, ev);
+    case A_PRINT:
+        ev = charKey(static_cast<char>(byte));
+        return true;
+    case A_ESCAPE:
+        ev = specialKey(KeyCode::Escape);
+        return true;
+    case A_ESC_DISPATCH:
+        return dispatchEscape(byte, ev);
+
+    case A_CSI_CLEAR:
+        m_params[0] = 0;
+        m_subParams[0] = 0;
+        m_paramCount = 0;
+        m_subField = 0;
+        m_marker = 0;
+        return false;
+    case A_PARAM: {
+        if (m_paramCount == 0) m_paramCount = 1;
+        if (byte == ';') {
+            if (m_paramCount < MAX_PARAMS) {
+                m_params[m_paramCount] = 0;
+                m_subParams[m_paramCount++] = 0;
+            }
+            m_subField = 0;
+            return false;
         }
-        if (c < '0' || (c > '9' && c != ';')) return false;
+        if (byte == ':') {
+            m_subField++;
+            return false;
+        }
+
+        // Only the parameter and its first sub-parameter are kept
+        if (m_subField > 1) return false;
+        int& p = (m_subField == 0 ? m_params : m_subParams)[m_paramCount - 1];
+        if (p < 100000) p = p * 10 + (byte - '0');
+        return false;
+    }
+    case A_MARKER:
+        m_marker = static_cast<char>(byte);
+        return false;
+    case A_CSI_DISPATCH:
+        return m_marker == '<' ? dispatchMouse(byte, ev) : dispatchCsi(byte, ev);
+    case A_SS3_DISPATCH:
+        return dispatchSs3(byte, ev);
+
+    case A_UTF8_START:
+        m_utf8[0] = static_cast<char>(byte);
+        m_utf8Len = 1;
+        m_utf8Need = byte < 0xE0 ? 2 : byte < 0xF0 ? 3 : 4;
+        return false;
+    case A_UTF8_NEXT: {
+        m_utf8[m_utf8Len++] = static_cast<char>(byte);
+        if (m_utf8Len < m_utf8Need) return false;
+
+        KeyEvent key;
+        std::memcpy(key.ch.data(), m_utf8.data(), m_utf8Len);
+        m_state = GROUND;
+        ev = key;
+        return true;
+    }
+    }
+    return false;
+}
+
+bool InputHandler::dispatchControl(u8 byte, Event& ev) const {
+    switch (byte) {
+        case 9:   ev = specialKey(KeyCode::Tab); return true;
+        case 10:  // LF
+        case 13:  ev = specialKey(KeyCode::Enter); return true;
+        case 127: ev = specialKey(KeyCode::Backspace); return true;
+        default:  break;
+    }
+
+    // Ctrl+A through Ctrl+Z
+    if (byte >= 1 && byte <= 26) {
+        ev = specialKey(static_cast<KeyCode>('a' + byte - 1), MOD_CTRL);
+        return true;
+    }
+    return false;
+}
+
+bool InputHandler::dispatchEscape(u8 byte, Event& ev) const {
+    if (byte >= 1 && byte <= 26) {
+        ev = specialKey(static_cast<KeyCode>('a' + byte - 1), MOD_ALT | MOD_CTRL);
+        return true;
+    }
+    if (byte >= 32 && byte <= 126) {
+        ev = charKey(static_cast<char>(byte), MOD_ALT);
+        return true;
     }
-    if (end < 0) return false;
+    return false;
+}
+
+bool InputHandler::dispatchCsi(u8 final, Event& ev) const {
+    if (m_marker != 0) return false;
+    if (final == 'u') return dispatchKitty(ev);
+
+    KeyCode code = final == '~' ? tildeKey(m_params[0]) : cursorKey(final);
+    if (code == KeyCode::None) return false;
+
+    // CSI 1 ; mods[:event] A, the event type only with the kitty protocol
+    KeyEvent key = specialKey(code, csiMods(m_paramCount >= 2 ? m_params[1] : 0));
+    if (m_paramCount >= 2) key.action = keyAction(m_subParams[1]);
+    ev = key;
+    return true;
+}
 
-    // Parse: btn;x;y
-    char tmp[32];
-    int len = end - 3;
-    if (len >= static_cast<int>(sizeof(tmp))) return false;
-    std::memcpy(tmp, m_buf.data() + m_pos + 3, len);
-    tmp[len] = '\0';
+bool InputHandler::dispatchKitty(Event& ev) const {
+    // Kitty keyboard protocol: CSI code[:alternates] ; mods[:event] u, with
+    // the code of the unshifted key. Text keys only come this way with
+    // modifiers other than shift, or as releases.
+    int code = m_params[0];
+    u8 mods = csiMods(m_paramCount >= 2 ? m_params[1] : 0);
 
-    int btn = 0, x = 0, y = 0;
-    if (std::sscanf(tmp, "%d;%d;%d", &btn, &x, &y) != 3) return false;
+    KeyEvent key;
+    switch (code) {
+        case 9:   key = specialKey(KeyCode::Tab, mods); break;
+        case 13:  key = specialKey(KeyCode::Enter, mods); break;
+        case 27:  key = specialKey(KeyCode::Escape, mods); break;
+        case 127: key = specialKey(KeyCode::Backspace, mods); break;
+        default:
+            // Non-ASCII text and the private use area (keypad, lone
+            // modifiers, media keys) have no KeyCode
+            if (code < 32 || code > 126) return false;
 
-    bool released = (peek(end) == 'm');
+            // Ctrl+letter as dispatchControl() reports it
+            key = (mods & MOD_CTRL) ? specialKey(static_cast<KeyCode>(code), mods)
+                                    : charKey(static_cast<char>(code), mods);
+            break;
+    }
+    if (m_paramCount >= 2) key.action = keyAction(m_subParams[1]);
+    ev = key;
+    return true;
+}
 
+bool InputHandler::dispatchMouse(u8 final, Event& ev) const {
+    // SGR reports: CSI < btn ; x ; y M (press, motion) or m (release)
+    if ((final != 'M' && final != 'm') || m_paramCount != 3) return false;
+
+    int btn = m_params[0];
     MouseEvent mouse;
-    mouse.x = x - 1;
-    mouse.y = y - 1;
+    mouse.x = m_params[1] - 1;
+    mouse.y = m_params[2] - 1;
     mouse.mods = MOD_NONE;
 
     // Decode modifiers from button code
@@ -96,250 +427,114 @@ bool InputHandler::parseMouseSgr(Event& ev) {
         mouse.action = (baseBtn == 3) ? MouseAction::Move : MouseAction::Drag;
     } else {
         mouse.button = (baseBtn == 3) ? MouseButton::None : static_cast<MouseButton>(baseBtn + 1);
-        mouse.action = released ? MouseAction::Release : MouseAction::Press;
+        mouse.action = (final == 'm') ? MouseAction::Release : MouseAction::Press;
     }
 
     ev = mouse;
-    consume(end + 1);
     return true;
 }
 
-bool InputHandler::parseCsi(Event& ev) {
-    if (!match("\x1b[", 2)) return false;
-
-    if (peek(2) == '<') {
-        return parseMouseSgr(ev);
-    }
-
-    int params[4] = {0};
-    int paramCount = 0;
-    int i = 2;
-    int currentParam = 0;
-
-    while (i < remaining()) {
-        char c = peek(i);
-
-        if (c >= '0' && c <= '9') {
-            currentParam = currentParam * 10 + (c - '0');
-            i++;
-        } else if (c == ';') {
-            if (paramCount < 4) params[paramCount++] = currentParam;
-            currentParam = 0;
-            i++;
-        } else if (c >= 0x40 && c <= 0x7E) {
-            // Final byte found
-            if (paramCount < 4) params[paramCount++] = currentParam;
-
-            KeyEvent key;
-            key.mods = MOD_NONE;
-            key.ch = {};
-
-            // Decode modifiers from param
-            if (paramCount >= 2 && params[1] > 1) {
-                int mod = params[1] - 1;
-                if (mod & MOD_SHIFT) key.mods |= MOD_SHIFT;
-                if (mod & MOD_ALT) key.mods |= MOD_ALT;
-                if (mod & MOD_CTRL) key.mods |= MOD_CTRL;
-            }
+bool InputHandler::dispatchSs3(u8 final, Event& ev) const {
+    KeyCode code = cursorKey(final);
+    if (code == KeyCode::None) return false;
+    ev = specialKey(code);
+    return true;
+}
 
-            // Decode key
-            switch (c) {
-                case 'A': key.key = KeyCode::Up; break;
-                case 'B': key.key = KeyCode::Down; break;
-                case 'C': key.key = KeyCode::Right; break;
-                case 'D': key.key = KeyCode::Left; break;
-                case 'H': key.key = KeyCode::Home; break;
-                case 'F': key.key = KeyCode::End; break;
-                case '~':
-                    switch (params[0]) {
-                        case 1:  key.key = KeyCode::Home; break;
-                        case 2:  key.key = KeyCode::Insert; break;
-                        case 3:  key.key = KeyCode::Delete; break;
-                        case 4:  key.key = KeyCode::End; break;
-                        case 5:  key.key = KeyCode::PageUp; break;
-                        case 6:  key.key = KeyCode::PageDown; break;
-                        case 11: key.key = KeyCode::F1; break;
-                        case 12: key.key = KeyCode::F2; break;
-                        case 13: key.key = KeyCode::F3; break;
-                        case 14: key.key = KeyCode::F4; break;
-                        case 15: key.key = KeyCode::F5; break;
-                        case 17: key.key = KeyCode::F6; break;
-                        case 18: key.key = KeyCode::F7; break;
-                        case 19: key.key = KeyCode::F8; break;
-                        case 20: key.key = KeyCode::F9; break;
-                        case 21: key.key = KeyCode::F10; break;
-                        case 23: key.key = KeyCode::F11; break;
-                        case 24: key.key = KeyCode::F12; break;
-                        default: key.key = KeyCode::None; break;
-                    }
-                    break;
-                default:
-                    key.key = KeyCode::None;
-                    break;
-            }
+std::optional<Event> InputHandler::poll() {
+    Event ev;
+    if (pollAll(&ev, 1) == 0) return std::nullopt;
+    return ev;
+}
 
-            consume(i + 1);
-            if (key.key != KeyCode::None) {
-                ev = key;
-                return true;
+size_t InputHandler::pollAll(Event* events, size_t max) {
+    size_t count = 0;
+    bool mayRead = true;
+    while (count < max) {
+        while (count < max && m_pos < m_len) {
+            if (!advance(static_cast<u8>(m_buf[m_pos++]), events[count])) continue;
+            if (auto* key = std::get_if<KeyEvent>(&events[count])) m_held.update(*key);
+            count++;
+        }
+        if (count == max) break;
+
+        // The buffer is used up (parser state keeps any partial sequence).
+        // Read once, and again only to tell whether a final ESC starts a
+        // sequence still on its way.
+        if (!mayRead && m_state != ESCAPE) break;
+        mayRead = false;
+        if (!read()) {
+            if (m_state == ESCAPE) {
+                m_state = GROUND;
+                events[count++] = specialKey(KeyCode::Escape);
             }
-            return false;
-        } else {
             break;
         }
     }
-
-    return false;
+    return count;
 }
 
-bool InputHandler::parseSs3(Event& ev) {
-    if (!match("\x1bO", 2)) return false;
-    if (remaining() < 3) return false;
-
-    char c = peek(2);
-
-    KeyEvent key;
-    key.mods = MOD_NONE;
-    key.ch = {};
-
-    switch (c) {
-        case 'P': key.key = KeyCode::F1; break;
-        case 'Q': key.key = KeyCode::F2; break;
-        case 'R': key.key = KeyCode::F3; break;
-        case 'S': key.key = KeyCode::F4; break;
-        case 'A': key.key = KeyCode::Up; break;
-        case 'B': key.key = KeyCode::Down; break;
-        case 'C': key.key = KeyCode::Right; break;
-        case 'D': key.key = KeyCode::Left; break;
-        case 'H': key.key = KeyCode::Home; break;
-        case 'F': key.key = KeyCode::End; break;
-        default:  return false;
-    }
+namespace {
 
-    ev = key;
-    consume(3);
-    return true;
+constexpr size_t heldIndex(KeyCode key) {
+    u16 k = static_cast<u16>(key);
+    return k >= 'A' && k <= 'Z' ? k + 32 : k;
 }
 
-bool InputHandler::parseAlt(Event& ev) {
-    if (peek(0) != '\x1b') return false;
-    if (remaining() < 2) return false;
+} // namespace
 
-    char c = peek(1);
+void HeldKeys::update(const KeyEvent& key) {
+    size_t i = heldIndex(key.key);
+    if (key.key == KeyCode::None || i >= WORDS * 64) return;
 
-    // Don't consume if it might be a CSI or SS3 sequence
-    if (c == '[' || c == 'O') return false;
-
-    KeyEvent key;
-    key.mods = MOD_ALT;
-
-    if (c >= 1 && c <= 26) {
-        key.key = static_cast<KeyCode>('a' + c - 1);
-        key.mods |= MOD_CTRL;
-        key.ch = {};
-    } else if (c >= 32 && c <= 126) {
-        key.key = static_cast<KeyCode>(c);
-        key.ch[0] = c;
-        key.ch[1] = '\0';
+    u64 bit = u64(1) << (i % 64);
+    if (key.action == KeyAction::Release) {
+        m_down[i / 64].fetch_and(~bit);
     } else {
-        return false;
+        m_down[i / 64].fetch_or(bit);
+        m_pressed[i / 64].fetch_or(bit);
     }
-
-    ev = key;
-    consume(2);
-    return true;
 }
 
-bool InputHandler::parseEscape(Event& ev) {
-    if (peek(0) != '\x1b') return false;
+bool HeldKeys::sample(KeyCode key) {
+    size_t i = heldIndex(key);
+    if (i >= WORDS * 64) return false;
 
-    if (remaining() == 1) {
-        KeyEvent key;
-        key.key = KeyCode::Escape;
-        key.mods = MOD_NONE;
-        key.ch = {};
-        ev = key;
-        consume(1);
-        return true;
-    }
-
-    return false;
+    u64 bit = u64(1) << (i % 64);
+    bool pressed = m_pressed[i / 64].fetch_and(~bit) & bit;
+    return pressed || (m_down[i / 64].load() & bit);
 }
 
-bool InputHandler::parseChar(Event& ev) {
-    char c = peek(0);
-    if (c == 0) return false;
-
-    KeyEvent key;
-    key.mods = MOD_NONE;
-
-    // Handle special control chars
-    switch (c) {
-        case 0:    return false;
-        case 9:    key.key = KeyCode::Tab; key.ch = {}; consume(1); ev = key; return true;
-        case 10:   // fallthrough (LF)
-        case 13:   key.key = KeyCode::Enter; key.ch = {}; consume(1); ev = key; return true;
-        case 27:   return false;  // escape handled elsewhere
-        case 127:  key.key = KeyCode::Backspace; key.ch = {}; consume(1); ev = key; return true;
-        default:   break;
-    }
-
-    // Control characters (Ctrl+A through Ctrl+Z)
-    if (c >= 1 && c <= 26) {
-        key.key = static_cast<KeyCode>('a' + c - 1);
-        key.mods = MOD_CTRL;
-        key.ch = {};
-        consume(1);
-        ev = key;
-        return true;
-    }
-
-    // Printable ASCII
-    if (c >= 32 && c <= 126) {
-        key.key = static_cast<KeyCode>(c);
-        key.ch[0] = c;
-        key.ch[1] = '\0';
-        consume(1);
-        ev = key;
-        return true;
-    }
-
-    // UTF-8
-    if (static_cast<unsigned char>(c) >= 0x80) {
-        int len = 1;
-        unsigned char first = static_cast<unsigned char>(c);
-        if ((first & 0xE0) == 0xC0) len = 2;
-        else if ((first & 0xF0) == 0xE0) len = 3;
-        else if ((first & 0xF8) == 0xF0) len = 4;
-
-        if (remaining() < len) return false;
+size_t coalesce(Event* events, size_t count) {
+    auto isMotion = [](const MouseEvent* m) {
+        return m && (m->action == MouseAction::Move || m->action == MouseAction::Drag);
+    };
+
+    size_t out = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (out > 0) {
+            Event& last = events[out - 1];
+
+            auto* key = std::get_if<KeyEvent>(&events[i]);
+            auto* lastKey = std::get_if<KeyEvent>(&last);
+            if (key && lastKey && key->sameKey(*lastKey) &&
+                u32(lastKey->count) + key->count <= UINT16_MAX) {
+                lastKey->count += key->count;
+                continue;
+            }
 
-        key.key = KeyCode::None;
-        std::memcpy(key.ch.data(), m_buf.data() + m_pos, len);
-        key.ch[len] = '\0';
-        consume(len);
-        ev = key;
-        return true;
+            auto* mouse = std::get_if<MouseEvent>(&events[i]);
+            auto* lastMouse = std::get_if<MouseEvent>(&last);
+            if (isMotion(mouse) && isMotion(lastMouse) && mouse->action == lastMouse->action &&
+                mouse->button == lastMouse->button && mouse->mods == lastMouse->mods) {
+                *lastMouse = *mouse;
+                continue;
+            }
+        }
+        if (out != i) events[out] = std::move(events[i]);
+        out++;
     }
-
-    return false;
-}
-
-std::optional<Event> InputHandler::poll() {
-    read();
-
-    if (remaining() == 0) return std::nullopt;
-
-    Event ev;
-
-    if (parseCsi(ev)) return ev;
-    if (parseSs3(ev)) return ev;
-    if (parseAlt(ev)) return ev;
-    if (parseEscape(ev)) return ev;
-    if (parseChar(ev)) return ev;
-
-    consume(1);
-    return std::nullopt;
+    return out;
 }
 
 bool InputHandler::isKey(const Event& ev, KeyCode key) {
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../common.hpp"
+#include <atomic>
+#include <unistd.h>
 
 namespace input {
 
@@ -60,10 +62,25 @@ enum class MouseAction : u8 {
     Drag,
 };
 
+// Key event types. Repeat and Release only come from terminals speaking
+// the kitty keyboard protocol; elsewhere every key is a Press.
+enum class KeyAction : u8 {
+    Press,
+    Repeat,
+    Release,
+};
+
 struct KeyEvent {
     KeyCode key = KeyCode::None;
     u8 mods = MOD_NONE;
     std::array<char, 5> ch = {};  // UTF-8 character if printable
+    u16 count = 1;                // > 1 for repeats merged by coalesce()
+    KeyAction action = KeyAction::Press;
+
+    bool sameKey(const KeyEvent& other) const {
+        return key == other.key && mods == other.mods && ch == other.ch &&
+               action == other.action;
+    }
 
     bool isChar(char c) const {
         if (mods != MOD_NONE) return false;
@@ -93,13 +110,67 @@ struct MouseEvent {
 // Event as variant
 using Event = std::variant<std::monostate, KeyEvent, MouseEvent>;
 
-// Input handler with buffered reading
+// Shrinks a batch of events in place and returns the new count: runs of
+// mouse motion keep only their last event, runs of the same key (held-key
+// autorepeat) become one KeyEvent with the run length as its count. The
+// order of what is left does not change.
+size_t coalesce(Event* events, size_t count);
+
+// Which keys are down, kept from the press and release events of a
+// terminal that reports releases. Updated by the thread polling the
+// InputHandler, sampled by another one.
+class HeldKeys {
+public:
+    void update(const KeyEvent& key);
+
+    // Whether key is down, or went down since the last sample of it: a tap
+    // shorter than the sampling period still counts once. Letters are
+    // tracked without case.
+    bool sample(KeyCode key);
+
+private:
+    static constexpr size_t WORDS = 5;  // key codes below 320
+    static_assert(static_cast<size_t>(KeyCode::F12) < WORDS * 64, "KeyCode outgrew the bitset");
+
+    std::array<std::atomic<u64>, WORDS> m_down = {};
+    std::array<std::atomic<u64>, WORDS> m_pressed = {};  // cleared by sample()
+};
+
+// Reads terminal input and decodes it with an incremental parser modelled
+// on the VT500 state machine: every byte goes through one table-driven
+// transition exactly once, and a sequence split across reads resumes
+// where it stopped.
 class InputHandler {
 public:
-    InputHandler();
+    // Reads events from fd (the terminal unless recorded input is replayed)
+    explicit InputHandler(int fd = STDIN_FILENO);
+    ~InputHandler();
+
+    InputHandler(const InputHandler&) = delete;
+    InputHandler& operator=(const InputHandler&) = delete;
 
+    // Blocks until poll() has input to parse, wake() is called or timeoutMs
+    // pass (-1: no limit). Returns true only in the first case. Once the
+    // input fd hangs up, only wake() and the timeout end the wait.
+    bool wait(int timeoutMs = -1);
+
+    // Ends a wait() in progress, or the next one; callable from any thread
+    void wake();
+
+    // Next event; pollAll() for one
     std::optional<Event> poll();
 
+    // Decodes the bytes read so far into events, reading once more when
+    // they run out, and returns how many were stored (at most max). A burst
+    // of input becomes a batch of events for one read() call. Bytes past
+    // the max-th event stay buffered for the next call. An ESC with nothing
+    // after it is the Escape key.
+    size_t pollAll(Event* events, size_t max);
+
+    // Keys down according to the events parsed so far. Only meaningful on
+    // terminals that report releases (see tui::Backend::keyReleases()).
+    HeldKeys& heldKeys() { return m_held; }
+
     // Convenience static methods
     static bool isKey(const Event& ev, KeyCode key);
     static bool isChar(const Event& ev, char c);
@@ -107,22 +178,41 @@ public:
     static const char* keyName(KeyCode key);
 
 private:
+    static constexpr int MAX_PARAMS = 16;
+    static constexpr size_t BUFFER_SIZE = 4096;  // a full burst of mouse reports
+
     bool read();
-    bool match(const char* seq, int len) const;
-    void consume(int n);
-    int remaining() const;
-    char peek(int offset) const;
-
-    bool parseCsi(Event& ev);
-    bool parseMouseSgr(Event& ev);
-    bool parseSs3(Event& ev);
-    bool parseAlt(Event& ev);
-    bool parseEscape(Event& ev);
-    bool parseChar(Event& ev);
-
-    std::array<char, 64> m_buf = {};
-    int m_len = 0;
-    int m_pos = 0;
+    int remaining() const { return m_len - m_pos; }
+
+    // Runs one byte through the state machine; true when it completed ev
+    bool advance(u8 byte, Event& ev);
+
+    bool dispatchControl(u8 byte, Event& ev) const;
+    bool dispatchEscape(u8 byte, Event& ev) const;
+    bool dispatchCsi(u8 final, Event& ev) const;
+    bool dispatchKitty(Event& ev) const;
+    bool dispatchMouse(u8 final, Event& ev) const;
+    bool dispatchSs3(u8 final, Event& ev) const;
+
+    int m_fd;
+    int m_wakeFd;           // eventfd signalled by wake()
+    bool m_hungUp = false;  // m_fd reported POLLHUP/POLLERR without data
+    std::array<char, BUFFER_SIZE> m_buf = {};
+    int m_len = 0;  // bytes in m_buf from the last read()
+    int m_pos = 0;  // bytes of them parsed
+
+    // Parser state (see input.cpp)
+    u8 m_state = 0;
+    std::array<int, MAX_PARAMS> m_params = {};  // CSI parameters, 0 when omitted
+    std::array<int, MAX_PARAMS> m_subParams = {};  // first ':' sub-parameter of each
+    int m_paramCount = 0;
+    int m_subField = 0;                         // ':' fields seen in the current parameter
+    char m_marker = 0;                          // CSI private marker ('<', '?', ...)
+    std::array<char, 4> m_utf8 = {};            // UTF-8 character being collected
+    int m_utf8Len = 0;
+    int m_utf8Need = 0;
+
+    HeldKeys m_held;
 };
 
 } // namespace input
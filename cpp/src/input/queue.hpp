@@ -0,0 +1,67 @@
+#pragma once
+
+#include "input.hpp"
+#include <atomic>
+
+namespace input {
+
+// An event with the time_us() it was parsed at
+struct TimedEvent {
+    Event event;
+    i64 time = 0;
+};
+
+// Fixed-size ring buffer between exactly one producer and one consumer
+// thread. Neither side locks or blocks: push() fails when the queue is
+// full, pop() when it is empty. Each index is written by one side only
+// and sits on its own cache line.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "capacity must be a power of two");
+
+public:
+    static constexpr size_t CAPACITY = Capacity;
+
+    // Producer side
+    bool push(const T& item) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_headCache == Capacity) {
+            m_headCache = m_head.load(std::memory_order_acquire);
+            if (tail - m_headCache == Capacity) return false;
+        }
+        m_items[tail & (Capacity - 1)] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& item) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tailCache) {
+            m_tailCache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tailCache) return false;
+        }
+        item = std::move(m_items[head & (Capacity - 1)]);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate while the other side is running
+    size_t size() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+private:
+    // Next slot to pop, and the consumer's last view of m_tail
+    alignas(64) std::atomic<size_t> m_head{0};
+    size_t m_tailCache = 0;
+
+    // Next slot to push, and the producer's last view of m_head
+    alignas(64) std::atomic<size_t> m_tail{0};
+    size_t m_headCache = 0;
+
+    alignas(64) std::array<T, Capacity> m_items{};
+};
+
+} // namespace input
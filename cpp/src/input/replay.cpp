@@ -0,0 +1,217 @@
+#include "replay.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace input {
+
+namespace {
+
+constexpr char MAGIC[4] = {'G', 'R', 'P', 'L'};
+constexpr u8 VERSION = 1;
+constexpr size_t FLUSH_SIZE = 4096;
+
+enum RecordType : u8 {
+    RECORD_END = 0,
+    RECORD_KEY = 1,
+    RECORD_MOUSE = 2,
+    RECORD_KEYFRAME = 3,
+};
+
+u64 zigzag(i64 v) {
+    return (static_cast<u64>(v) << 1) ^ static_cast<u64>(v >> 63);
+}
+
+i64 unzigzag(u64 v) {
+    return static_cast<i64>(v >> 1) ^ -static_cast<i64>(v & 1);
+}
+
+// Bounds-checked reader over the loaded file
+class Reader {
+public:
+    Reader(const std::vector<u8>& data, const std::string& path)
+        : m_data(data), m_path(path) {}
+
+    bool done() const { return m_pos >= m_data.size(); }
+
+    u8 byte() {
+        if (done()) fail("truncated");
+        return m_data[m_pos++];
+    }
+
+    u64 varint() {
+        u64 v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            u8 b = byte();
+            v |= static_cast<u64>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return v;
+        }
+        fail("bad varint");
+    }
+
+    [[noreturn]] void fail(const char* what) const {
+        throw std::runtime_error(m_path + ": " + what + " at byte " + std::to_string(m_pos));
+    }
+
+private:
+    const std::vector<u8>& m_data;
+    const std::string& m_path;
+    size_t m_pos = 0;
+};
+
+} // namespace
+
+Recorder::Recorder(const std::string& path, int tps)
+    : m_file(std::fopen(path.c_str(), "wb")) {
+    if (!m_file) throw std::runtime_error(path + ": cannot create");
+
+    m_buf.reserve(FLUSH_SIZE * 2);
+    m_buf.insert(m_buf.end(), MAGIC, MAGIC + sizeof(MAGIC));
+    m_buf.push_back(VERSION);
+    putVarint(static_cast<u64>(tps));
+}
+
+Recorder::~Recorder() {
+    finish(m_lastTick);
+}
+
+void Recorder::add(u64 tick, const Event& ev) {
+    if (!m_file) return;
+
+    if (auto* key = std::get_if<KeyEvent>(&ev)) {
+        putTick(tick);
+        m_buf.push_back(RECORD_KEY);
+        putVarint(static_cast<u64>(key->key));
+        m_buf.push_back(key->mods);
+        u8 len = 0;
+        while (len < key->ch.size() && key->ch[len]) len++;
+        m_buf.push_back(len);
+        m_buf.insert(m_buf.end(), key->ch.begin(), key->ch.begin() + len);
+        putVarint(key->count);
+    } else if (auto* mouse = std::get_if<MouseEvent>(&ev)) {
+        putTick(tick);
+        m_buf.push_back(RECORD_MOUSE);
+        m_buf.push_back(static_cast<u8>(mouse->button));
+        m_buf.push_back(static_cast<u8>(mouse->action));
+        putVarint(static_cast<u64>(std::max(mouse->x, 0)));
+        putVarint(static_cast<u64>(std::max(mouse->y, 0)));
+        m_buf.push_back(mouse->mods);
+    }
+
+    if (m_buf.size() >= FLUSH_SIZE) flush();
+}
+
+void Recorder::keyframe(u64 tick, const std::vector<i64>& state) {
+    if (!m_file) return;
+
+    putTick(tick);
+    m_buf.push_back(RECORD_KEYFRAME);
+    putVarint(state.size());
+    for (size_t i = 0; i < state.size(); i++) {
+        i64 prev = i < m_lastKeyframe.size() ? m_lastKeyframe[i] : 0;
+        putVarint(zigzag(static_cast<i64>(static_cast<u64>(state[i]) - static_cast<u64>(prev))));
+    }
+    m_lastKeyframe = state;
+
+    if (m_buf.size() >= FLUSH_SIZE) flush();
+}
+
+void Recorder::finish(u64 tick) {
+    if (!m_file) return;
+
+    putTick(std::max(tick, m_lastTick));
+    m_buf.push_back(RECORD_END);
+    flush();
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+void Recorder::putVarint(u64 v) {
+    while (v >= 0x80) {
+        m_buf.push_back(static_cast<u8>(v | 0x80));
+        v >>= 7;
+    }
+    m_buf.push_back(static_cast<u8>(v));
+}
+
+void Recorder::putTick(u64 tick) {
+    putVarint(tick - m_lastTick);
+    m_lastTick = tick;
+}
+
+void Recorder::flush() {
+    if (!m_buf.empty()) std::fwrite(m_buf.data(), 1, m_buf.size(), m_file);
+    m_buf.clear();
+}
+
+Replay Replay::load(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) throw std::runtime_error(path + ": cannot open");
+
+    std::vector<u8> data;
+    u8 chunk[4096];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    std::fclose(f);
+
+    Reader in(data, path);
+    for (char c : MAGIC) {
+        if (in.byte() != static_cast<u8>(c)) in.fail("not a replay file");
+    }
+    if (in.byte() != VERSION) in.fail("unsupported version");
+
+    Replay replay;
+    replay.tps = static_cast<int>(in.varint());
+    if (replay.tps <= 0) in.fail("bad tps");
+
+    u64 tick = 0;
+    for (;;) {
+        tick += in.varint();
+        u8 type = in.byte();
+
+        if (type == RECORD_END) {
+            replay.ticks = tick;
+            break;
+        }
+
+        if (type == RECORD_KEY) {
+            KeyEvent key;
+            key.key = static_cast<KeyCode>(in.varint());
+            key.mods = in.byte();
+            u8 len = in.byte();
+            if (len > key.ch.size()) in.fail("bad key event");
+            for (u8 i = 0; i < len; i++) key.ch[i] = static_cast<char>(in.byte());
+            u64 count = in.varint();
+            if (count == 0 || count > UINT16_MAX) in.fail("bad key event");
+            key.count = static_cast<u16>(count);
+            replay.events.push_back({tick, key});
+        } else if (type == RECORD_MOUSE) {
+            MouseEvent mouse;
+            mouse.button = static_cast<MouseButton>(in.byte());
+            mouse.action = static_cast<MouseAction>(in.byte());
+            mouse.x = static_cast<int>(in.varint());
+            mouse.y = static_cast<int>(in.varint());
+            mouse.mods = in.byte();
+            replay.events.push_back({tick, mouse});
+        } else if (type == RECORD_KEYFRAME) {
+            const std::vector<i64>* prev =
+                replay.keyframes.empty() ? nullptr : &replay.keyframes.back().state;
+            Keyframe kf{tick, {}};
+            u64 count = in.varint();
+            if (count > data.size()) in.fail("bad keyframe");
+            kf.state.resize(count);
+            for (u64 i = 0; i < count; i++) {
+                i64 base = prev && i < prev->size() ? (*prev)[i] : 0;
+                kf.state[i] = static_cast<i64>(static_cast<u64>(base) + static_cast<u64>(unzigzag(in.varint())));
+            }
+            replay.keyframes.push_back(std::move(kf));
+        } else {
+            in.fail("unknown record");
+        }
+    }
+    return replay;
+}
+
+} // namespace input
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "input.hpp"
+#include <cstdio>
+
+namespace input {
+
+// Recorded input sessions. A replay file is
+//
+//   header   "GRPL", version byte (1), varint tps
+//   records  varint tick delta, type byte, payload
+//              key      (1): varint key code, mods byte, ch length byte, ch,
+//                            varint repeat count
+//              mouse    (2): button byte, action byte, varint x, varint y,
+//                            mods byte
+//              keyframe (3): varint word count, then per word the zigzag
+//                            varint difference to the same word of the
+//                            previous keyframe (0 past its end)
+//              end      (0): no payload, last record
+//
+// Varints are unsigned LEB128. A record's tick is the number of game ticks
+// that had run when the event was applied; the end record's tick is the
+// tick the session stopped on. A keyframe holds the application state
+// (Application::saveState) after its tick and before that tick's events.
+
+struct RecordedEvent {
+    u64 tick;
+    Event event;
+};
+
+struct Keyframe {
+    u64 tick;
+    std::vector<i64> state;
+};
+
+// Appends events to a replay file while the game runs
+class Recorder {
+public:
+    // Throws std::runtime_error if the file cannot be created
+    Recorder(const std::string& path, int tps);
+    ~Recorder();
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    // Ticks must not decrease between calls, including keyframe()
+    void add(u64 tick, const Event& ev);
+    void keyframe(u64 tick, const std::vector<i64>& state);
+
+    // Writes the end record and closes the file; further calls do nothing
+    void finish(u64 tick);
+
+private:
+    void putVarint(u64 v);
+    void putTick(u64 tick);
+    void flush();
+
+    FILE* m_file;
+    std::vector<u8> m_buf;
+    u64 m_lastTick = 0;
+    std::vector<i64> m_lastKeyframe;
+};
+
+struct Replay {
+    int tps = 0;
+    u64 ticks = 0;  // tick of the end record
+    std::vector<RecordedEvent> events;
+    std::vector<Keyframe> keyframes;  // decoded, by tick
+
+    // Reads a whole replay file; throws std::runtime_error if it is missing,
+    // truncated or not a replay
+    static Replay load(const std::string& path);
+};
+
+} // namespace input
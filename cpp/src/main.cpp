@@ -1,293 +1,123 @@
-#include "common.hpp"
-#include "tui/screen.hpp"
-#include "input/input.hpp"
-#include "ui/frame.hpp"
-#include "ui/panel.hpp"
-#include "ui/menu.hpp"
-#include "game/game.hpp"
-#include "game/level.hpp"
-
-#include <thread>
-#include <mutex>
-#include <atomic>
-#include <chrono>
-
-enum class ScreenType {
-    Game,
-    Menu,
-    GameOver,
-    Win
-};
-
-class Application {
-public:
-    Application()
-        : m_game(11, 11, 4)
-        , m_rootFrame(m_screen.width(), m_screen.height(), 0, 0) {
-
-        setupGame();
-        setupLayout();
-        setupMenu();
-    }
-
-    void run() {
-        render();
-
-        std::thread inputThread(&Application::inputLoop, this);
-
-        auto sleepTime = std::chrono::microseconds(US_PER_SEC / m_game.tps());
-
-        while (m_running) {
-            {
-                std::lock_guard<std::mutex> lock(m_mutex);
-
-                if (m_game.status() == game::GameStatus::Running) {
-                    m_game.update(sleepTime.count());
-                    m_game.removeDeadEntities();
-
-                    // Check level completion
-                    if (m_game.enemies().empty() && m_game.player() && m_game.player()->isAlive()) {
-                        m_game.incrementLevel();
-                        if (m_game.level() > game::LEVEL_COUNT) {
-                            m_game.setStatus(game::GameStatus::Finished);
-                            m_currentScreen = ScreenType::Win;
-                        } else {
-                            game::spawnLevel(m_game, game::LEVELS[m_game.level() - 1]);
-                        }
-                    }
+#include "app.hpp"
+#include "benchmark.hpp"
+#include "tui/cast.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+int usage(const char* prog) {
+    std::fprintf(stderr,
+                 "usage: %s [--record <file>] [--cast <file>] [--stats] [--no-rep]\n"
+                 "       %s --replay <file> [--fast] [--cast <file>] [--no-rep]\n"
+                 "       %s --bench <scenario> [--ticks N] [--size WxH] [--seed N]\n"
+                 "       %s --scenario <file> [--trace <file>]\n",
+                 prog, prog, prog, prog);
+    return 2;
+}
 
-                    if (m_game.status() == game::GameStatus::GameOver) {
-                        m_currentScreen = ScreenType::GameOver;
-                    }
-                }
+bool isFlag(const char* arg, const char* flag) {
+    return std::strcmp(arg, flag) == 0;
+}
 
-                render();
-            }
+} // namespace
 
-            std::this_thread::sleep_for(sleepTime);
+int main(int argc, char** argv) {
+    if (argc >= 3 && isFlag(argv[1], "--scenario")) {
+        if (argc == 3) return benchmark::runScenario(argv[2]);
+        if (argc == 5 && isFlag(argv[3], "--trace")) {
+            return benchmark::runScenario(argv[2], argv[4]);
         }
-
-        m_running = false;
-        inputThread.join();
+        return usage(argv[0]);
     }
 
-private:
-    void setupGame() {
-        m_game.spawnPlayer((m_game.bounds().w - 1) / 2,
-                           m_game.bounds().h - 1, 5, 1, 2);
-        game::spawnLevel(m_game, game::LEVELS[0]);
+    if (argc > 1 && isFlag(argv[1], "--bench")) {
+        benchmark::Options options;
+        if (!benchmark::parseArgs(argc, argv, options)) return usage(argv[0]);
+        return benchmark::run(options);
     }
 
-    void setupLayout() {
-        auto split1 = m_rootFrame.split(
-            m_rootFrame.height() - 4, ui::FrameSplit::Horizontal);
-        ui::Frame& topFrame = split1.first;
-        ui::Frame& bottomFrame = split1.second;
-
-        auto split2 = topFrame.split(
-            topFrame.width() * 2 / 3, ui::FrameSplit::Vertical);
-        ui::Frame& gameFrame = split2.first;
-        ui::Frame& statsFrame = split2.second;
-
-        auto controls = std::make_unique<ui::Panel>();
-        controls->addEmptyLine();
-        controls->addText(" Controls:    [<] / [a] Left    [>] / [d] Right "
-                         "   [space] Shoot    [q] Quit    [m] Menu");
-        bottomFrame.addWidget(std::move(controls));
-
-        auto stats = std::make_unique<ui::Panel>();
-        game::Game* g = &m_game;
-        stats->addValue(" Level", [g]() { return std::to_string(g->level()); });
-        stats->addValue(" Score", [g]() { return std::to_string(g->score()); });
-        if (g->player()) {
-            game::Player* p = g->player();
-            stats->addValue(" Lives", [p]() { return std::to_string(p->health()); });
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    const char* castPath = nullptr;
+    bool fast = false;
+    bool stats = false;
+    bool noRep = false;  // never send REP, whatever the terminal reports
+    for (int i = 1; i < argc; i++) {
+        if (isFlag(argv[i], "--fast")) {
+            fast = true;
+        } else if (isFlag(argv[i], "--stats")) {
+            stats = true;
+        } else if (isFlag(argv[i], "--no-rep")) {
+            noRep = true;
+        } else if (i + 1 < argc && isFlag(argv[i], "--record")) {
+            recordPath = argv[++i];
+        } else if (i + 1 < argc && isFlag(argv[i], "--replay")) {
+            replayPath = argv[++i];
+        } else if (i + 1 < argc && isFlag(argv[i], "--cast")) {
+            castPath = argv[++i];
+        } else {
+            return usage(argv[0]);
         }
-        stats->addEmptyLine();
-        stats->addValue(" Kills", [g]() { return std::to_string(g->kills()); });
-        stats->addValue(" Accuracy", [g]() { return std::to_string(g->accuracyPercent()) + "%"; });
-        stats->addValue(" Time", [g]() {
-            int secs = g->timeSeconds();
-            int mins = secs / 60;
-            secs = secs % 60;
-            if (mins > 0) {
-                return std::to_string(mins) + ":" + (secs < 10 ? "0" : "") + std::to_string(secs);
-            }
-            return std::to_string(secs) + "s";
-        });
-        stats->addEmptyLine();
-        stats->addValue(" # Bullets on screen", [g]() { return std::to_string(g->bulletCount()); });
-        stats->addValue(" # Enemies remaining", [g]() { return std::to_string(g->enemyCount()); });
-        statsFrame.addWidget(std::move(stats));
-
-        class GameWidget : public ui::Widget {
-        public:
-            explicit GameWidget(game::Game* game) : m_game(game) {}
-            void draw(tui::Screen& screen, ui::BBox bbox) override {
-                if (m_game) m_game->draw(screen, bbox);
-            }
-        private:
-            game::Game* m_game;
-        };
-
-        gameFrame.addWidget(std::make_unique<GameWidget>(&m_game));
-    }
-
-    void setupMenu() {
-        m_menu.addEntry("Menu:", false, nullptr);
-        m_menu.addSeparator();
-        m_menu.addEntry("Continue", true, [this]() {
-            if (m_game.status() == game::GameStatus::Paused) {
-                m_game.setStatus(game::GameStatus::Running);
-            }
-            m_currentScreen = ScreenType::Game;
-        });
-        m_menu.addEntry("New Game", true, [this]() {
-            startNewGame();
-        });
-        m_menu.addEntry("Quit", true, [this]() {
-            m_running = false;
-        });
-
-        m_menu.moveDown();
-
-        m_gameOverMenu.addEntry("Game Over!", false, nullptr);
-        m_gameOverMenu.addSeparator();
-        m_gameOverMenu.addEntry("New Game", true, [this]() {
-            startNewGame();
-        });
-        m_gameOverMenu.addEntry("Quit", true, [this]() {
-            m_running = false;
-        });
-
-        m_gameOverMenu.moveDown();
-
-        m_winMenu.addEntry("You Win!", false, nullptr);
-        m_winMenu.addSeparator();
-        m_winMenu.addEntry("New Game", true, [this]() {
-            startNewGame();
-        });
-        m_winMenu.addEntry("Quit", true, [this]() {
-            m_running = false;
-        });
-
-        m_winMenu.moveDown();
     }
-
-    void startNewGame() {
-        m_game.reset();
-        game::spawnLevel(m_game, game::LEVELS[0]);
-        m_currentScreen = ScreenType::Game;
+    if ((fast && !replayPath) || (stats && replayPath) || (recordPath && replayPath)) {
+        return usage(argv[0]);
     }
 
-    void processInput(const input::Event& ev) {
-        auto* keyEv = std::get_if<input::KeyEvent>(&ev);
-        if (!keyEv) return;
-
-        if (keyEv->isChar('q') || keyEv->isChar('Q')) {
-            m_running = false;
-            return;
-        }
-
-        switch (m_currentScreen) {
-        case ScreenType::Game:
-            if (keyEv->isChar('m') || keyEv->isChar('M')) {
-                m_game.setStatus(game::GameStatus::Paused);
-                m_currentScreen = ScreenType::Menu;
-                return;
-            }
-            m_game.processInput(ev);
-            break;
-
-        case ScreenType::Menu:
-            if (keyEv->isKey(input::KeyCode::Up)) {
-                m_menu.moveUp();
-            } else if (keyEv->isKey(input::KeyCode::Down)) {
-                m_menu.moveDown();
-            } else if (keyEv->isKey(input::KeyCode::Enter)) {
-                m_menu.select();
-            }
-            break;
-
-        case ScreenType::GameOver:
-            if (keyEv->isKey(input::KeyCode::Up)) {
-                m_gameOverMenu.moveUp();
-            } else if (keyEv->isKey(input::KeyCode::Down)) {
-                m_gameOverMenu.moveDown();
-            } else if (keyEv->isKey(input::KeyCode::Enter)) {
-                m_gameOverMenu.select();
+    // On failure the terminal, if already set up, is restored before the
+    // message is printed
+    input::Replay replay;
+    std::unique_ptr<input::Recorder> recorder;
+    std::unique_ptr<tui::Backend> backend;
+    try {
+        if (replayPath) {
+            replay = input::Replay::load(replayPath);
+            if (replay.tps != Application::TICKS_PER_SECOND) {
+                throw std::runtime_error(std::string(replayPath) + ": recorded at " +
+                                         std::to_string(replay.tps) + " tps, the game runs at " +
+                                         std::to_string(Application::TICKS_PER_SECOND));
             }
-            break;
-
-        case ScreenType::Win:
-            if (keyEv->isKey(input::KeyCode::Up)) {
-                m_winMenu.moveUp();
-            } else if (keyEv->isKey(input::KeyCode::Down)) {
-                m_winMenu.moveDown();
-            } else if (keyEv->isKey(input::KeyCode::Enter)) {
-                m_winMenu.select();
-            }
-            break;
         }
-    }
-
-    void inputLoop() {
-        while (m_running) {
-            std::optional<input::Event> ev;
-
-            {
-                std::lock_guard<std::mutex> lock(m_mutex);
-                ev = m_input.poll();
-            }
-
-            if (ev) {
-                std::lock_guard<std::mutex> lock(m_mutex);
-                processInput(*ev);
-                render();
-            }
-
-            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        if (recordPath) {
+            recorder = std::make_unique<input::Recorder>(recordPath, Application::TICKS_PER_SECOND);
+        }
+        backend = std::make_unique<tui::TtyBackend>();
+        if (castPath) {
+            backend = std::make_unique<tui::CastBackend>(std::move(backend), castPath);
         }
+    } catch (const std::runtime_error& e) {
+        backend.reset();
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
     }
 
-    void render() {
-        m_screen.clear();
-
-        switch (m_currentScreen) {
-        case ScreenType::Game:
-            m_rootFrame.draw(m_screen);
-            break;
-        case ScreenType::Menu:
-            m_menu.draw(m_screen);
-            break;
-        case ScreenType::GameOver:
-            m_gameOverMenu.draw(m_screen);
-            break;
-        case ScreenType::Win:
-            m_winMenu.draw(m_screen);
-            break;
+    // Statistics are printed once the terminal is restored
+    InputQueueStats queue;
+    {
+        Application app(std::move(backend));
+        if (noRep) {
+            tui::EncoderOptions options = app.screen().encoderOptions();
+            options.repeat = false;
+            app.screen().setEncoderOptions(options);
         }
-
-        m_screen.flush();
+        if (replayPath) {
+            app.replay(replay, !fast);
+        } else {
+            if (recorder) app.setRecorder(std::move(recorder));
+            app.run();
+        }
+        queue = app.inputQueueStats();
     }
 
-    std::mutex m_mutex;
-    std::atomic<bool> m_running{true};
-
-    tui::Screen m_screen;
-    input::InputHandler m_input;
-
-    game::Game m_game;
-    ui::Frame m_rootFrame;
-    ui::Menu m_menu;
-    ui::Menu m_gameOverMenu;
-    ui::Menu m_winMenu;
-
-    ScreenType m_currentScreen = ScreenType::Game;
-};
-
-int main() {
-    Application app;
-    app.run();
+    if (stats) {
+        std::fprintf(stderr, "input queue: %llu events, wait mean %.1f ms, max %.1f ms, "
+                     "%llu dropped, %llu coalesced\n",
+                     static_cast<unsigned long long>(queue.events),
+                     queue.events ? queue.totalWaitUs / 1000.0 / queue.events : 0.0,
+                     queue.maxWaitUs / 1000.0, static_cast<unsigned long long>(queue.dropped),
+                     static_cast<unsigned long long>(queue.coalesced));
+    }
     return 0;
 }
@@ -0,0 +1,146 @@
+#include "scenario.hpp"
+#include "game/level.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace scenario {
+
+namespace {
+
+bool parseKey(const std::string& name, input::KeyCode& key) {
+    using input::KeyCode;
+    static const std::pair<const char*, KeyCode> NAMED[] = {
+        {"none", KeyCode::None},
+        {"space", static_cast<KeyCode>(' ')},
+        {"enter", KeyCode::Enter},
+        {"esc", KeyCode::Escape},
+        {"up", KeyCode::Up},
+        {"down", KeyCode::Down},
+        {"left", KeyCode::Left},
+        {"right", KeyCode::Right},
+    };
+
+    for (const auto& [n, k] : NAMED) {
+        if (name == n) {
+            key = k;
+            return true;
+        }
+    }
+
+    if (name.size() == 1 && name[0] > ' ' && name[0] < 0x7F) {
+        key = static_cast<KeyCode>(name[0]);
+        return true;
+    }
+    return false;
+}
+
+std::string baseName(const std::string& path) {
+    size_t slash = path.rfind('/');
+    std::string base = slash == std::string::npos ? path : path.substr(slash + 1);
+    return base.substr(0, base.find('.'));
+}
+
+bool parseLine(Script& s, const std::string& line) {
+    std::vector<std::string> words;
+    std::istringstream in(line);
+    for (std::string w; in >> w;) {
+        if (w[0] == '#') break;
+        words.push_back(w);
+    }
+    if (words.empty()) return true;
+
+    const std::string& cmd = words[0];
+    size_t count = words.size();
+    auto num = [&](size_t i) { return std::atoi(words[i].c_str()); };
+
+    if (cmd == "seed" && count == 2) {
+        s.seed = static_cast<u32>(std::strtoul(words[1].c_str(), nullptr, 10));
+    } else if (cmd == "ticks" && count == 2) {
+        s.ticks = num(1);
+    } else if (cmd == "size" && count == 2) {
+        return std::sscanf(words[1].c_str(), "%dx%d", &s.width, &s.height) == 2;
+    } else if (cmd == "level" && count == 2) {
+        s.level = num(1);
+    } else if (cmd == "health" && count == 2) {
+        s.health = num(1);
+    } else if (cmd == "key" && count == 3) {
+        TimedKey k{0, num(1)};
+        if (!parseKey(words[2], k.key)) return false;
+        s.keys.push_back(k);
+    } else if (cmd == "repeat" && count == 4) {
+        TimedKey k{num(1), num(2)};
+        if (k.period <= 0 || !parseKey(words[3], k.key)) return false;
+        s.keys.push_back(k);
+    } else if (cmd == "random" && count >= 3) {
+        s.randomPeriod = num(1);
+        if (s.randomPeriod <= 0) return false;
+        s.randomKeys.clear();
+        for (size_t i = 2; i < count; i++) {
+            input::KeyCode key;
+            if (!parseKey(words[i], key)) return false;
+            s.randomKeys.push_back(key);
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void pushKey(std::vector<input::Event>& out, input::KeyCode code) {
+    if (code == input::KeyCode::None) return;
+
+    input::KeyEvent ev;
+    ev.key = code;
+    if (static_cast<u16>(code) < 0x7F) ev.ch[0] = static_cast<char>(code);
+    out.push_back(ev);
+}
+
+} // namespace
+
+Script Script::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error(path + ": cannot open");
+
+    Script s;
+    s.name = baseName(path);
+
+    std::string line;
+    for (int lineNo = 1; std::getline(file, line); lineNo++) {
+        if (!parseLine(s, line)) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNo) + ": invalid directive");
+        }
+    }
+
+    if (s.ticks <= 0 || s.width <= 0 || s.height <= 0 ||
+        s.level < 1 || s.level > game::LEVEL_COUNT) {
+        throw std::runtime_error(path + ": ticks, size or level out of range");
+    }
+    return s;
+}
+
+void Script::events(int tick, u32& rng, std::vector<input::Event>& out) const {
+    for (const auto& k : keys) {
+        bool due = k.period ? tick % k.period == k.offset : tick == k.offset;
+        if (due) pushKey(out, k.key);
+    }
+
+    if (randomPeriod > 0 && !randomKeys.empty() && tick % randomPeriod == 0) {
+        u32 r = nextRandom(rng);
+        pushKey(out, randomKeys[r % randomKeys.size()]);
+    }
+}
+
+u32 nextRandom(u32& state) {
+    u32 x = state ? state : 1;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state = x;
+    return x;
+}
+
+} // namespace scenario
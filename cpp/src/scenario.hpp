@@ -0,0 +1,52 @@
+#pragma once
+
+#include "common.hpp"
+#include "input/input.hpp"
+
+// Headless run description shared with the C version (scenarios/*.txt).
+// One directive per line, '#' starts a comment:
+//   seed <n>                 generator seed for `random`
+//   ticks <n>                game ticks to run
+//   size <w>x<h>             screen size in cells
+//   level <n>                starting level
+//   health <n>               player health at the start
+//   key <tick> <key>         one key event before that tick
+//   repeat <period> <offset> <key>
+//                            a key event before every tick t with
+//                            t % period == offset
+//   random <period> <key>... before every period-th tick, one key picked
+//                            by the seeded generator
+// Keys are single characters or one of space, enter, esc, up, down, left,
+// right; `none` sends nothing.
+namespace scenario {
+
+struct TimedKey {
+    int period = 0;  // 0: only at tick `offset`
+    int offset = 0;
+    input::KeyCode key = input::KeyCode::None;
+};
+
+struct Script {
+    std::string name;  // file name without directory and extension
+    u32 seed = 1;
+    int ticks = 1000;
+    int width = 120;
+    int height = 40;
+    int level = 1;
+    int health = 0;    // 0 keeps the default
+    std::vector<TimedKey> keys;
+    int randomPeriod = 0;
+    std::vector<input::KeyCode> randomKeys;
+
+    // Parses the scenario file; throws std::runtime_error naming the
+    // offending line
+    static Script load(const std::string& path);
+
+    // Appends the key events for tick t, in the same order as the C version
+    void events(int tick, u32& rng, std::vector<input::Event>& out) const;
+};
+
+// Next value of the xorshift32 generator both versions use
+u32 nextRandom(u32& state);
+
+} // namespace scenario
@@ -0,0 +1,15 @@
+#include "backend.hpp"
+#include <unistd.h>
+
+namespace tui {
+
+bool TtyBackend::write(OutputBuffer& frame) {
+    return frame.writeTo(STDOUT_FILENO);
+}
+
+bool MemoryBackend::write(OutputBuffer& frame) {
+    frame.copyTo(m_bytes);
+    return true;
+}
+
+} // namespace tui
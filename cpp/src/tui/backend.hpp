@@ -0,0 +1,82 @@
+#pragma once
+
+#include "terminal.hpp"
+#include "output.hpp"
+
+namespace tui {
+
+// Where a Screen sends its frames
+class Backend {
+public:
+    virtual ~Backend() = default;
+
+    // Size in cells
+    virtual std::pair<int, int> size() const = 0;
+
+    // Whether frames may be bracketed with BSU/ESU
+    virtual bool synchronizedOutput() const { return false; }
+
+    // Whether key input includes release events (kitty keyboard protocol)
+    virtual bool keyReleases() const { return false; }
+
+    // Whether runs of identical cells may be sent with REP
+    virtual bool repeatCells() const { return false; }
+
+    // Sends one frame; false on a write error
+    virtual bool write(OutputBuffer& frame) = 0;
+};
+
+// The controlling terminal: raw mode for the backend's lifetime, frames
+// written to stdout
+class TtyBackend : public Backend {
+public:
+    std::pair<int, int> size() const override { return m_terminal.size(); }
+    bool synchronizedOutput() const override { return m_terminal.synchronizedOutput(); }
+    bool keyReleases() const override { return m_terminal.keyReleases(); }
+    bool repeatCells() const override { return m_terminal.repeatCells(); }
+    bool write(OutputBuffer& frame) override;
+
+private:
+    Terminal m_terminal;
+};
+
+// Fixed-size target that keeps every byte written, for tools and
+// inspecting output
+class MemoryBackend : public Backend {
+public:
+    MemoryBackend(int width, int height) : m_width(width), m_height(height) {}
+
+    std::pair<int, int> size() const override { return {m_width, m_height}; }
+    bool write(OutputBuffer& frame) override;
+
+    void setSize(int width, int height) {
+        m_width = width;
+        m_height = height;
+    }
+
+    const std::string& bytes() const { return m_bytes; }
+    void clearBytes() { m_bytes.clear(); }
+
+private:
+    int m_width, m_height;
+    std::string m_bytes;
+};
+
+// Fixed-size target that discards frames
+class NullBackend : public Backend {
+public:
+    NullBackend(int width, int height) : m_width(width), m_height(height) {}
+
+    std::pair<int, int> size() const override { return {m_width, m_height}; }
+    bool write(OutputBuffer& frame) override { return true; }
+
+    void setSize(int width, int height) {
+        m_width = width;
+        m_height = height;
+    }
+
+private:
+    int m_width, m_height;
+};
+
+} // namespace tui
@@ -0,0 +1,131 @@
+#include "cast.hpp"
+
+#include <cstdlib>
+#include <ctime>
+#include <stdexcept>
+
+namespace tui {
+
+namespace {
+
+constexpr size_t PENDING_RESERVE = 256 * 1024;
+
+void appendJsonString(std::string& out, const char* s, size_t len) {
+    static const char HEX[] = "0123456789abcdef";
+
+    out += '"';
+    for (size_t i = 0; i < len; i++) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20 || c == 0x7F) {
+                out += "\\u00";
+                out += HEX[c >> 4];
+                out += HEX[c & 0xF];
+            } else {
+                out += static_cast<char>(c);
+            }
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+CastBackend::CastBackend(std::unique_ptr<Backend> inner, const std::string& path)
+    : m_inner(std::move(inner))
+    , m_file(std::fopen(path.c_str(), "w"))
+    , m_start(std::chrono::steady_clock::now()) {
+    if (!m_file) throw std::runtime_error(path + ": cannot create");
+
+    auto [width, height] = m_inner->size();
+    std::string header = "{\"version\": 2, \"width\": " + std::to_string(width) +
+                         ", \"height\": " + std::to_string(height) +
+                         ", \"timestamp\": " + std::to_string(std::time(nullptr));
+    if (const char* term = std::getenv("TERM")) {
+        header += ", \"env\": {\"TERM\": ";
+        appendJsonString(header, term, std::char_traits<char>::length(term));
+        header += "}";
+    }
+    header += "}\n";
+    std::fwrite(header.data(), 1, header.size(), m_file);
+
+    m_pending.reserve(PENDING_RESERVE);
+    m_thread = std::thread(&CastBackend::run, this);
+}
+
+CastBackend::~CastBackend() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+    std::fclose(m_file);
+}
+
+bool CastBackend::write(OutputBuffer& frame) {
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pending.size() + frame.size() > MAX_PENDING) {
+            m_skipped++;
+        } else {
+            frame.copyTo(m_pending);
+            m_events.push_back({time, m_pending.size()});
+        }
+    }
+    m_cv.notify_one();
+
+    return m_inner->write(frame);
+}
+
+u64 CastBackend::skippedFrames() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_skipped;
+}
+
+void CastBackend::run() {
+    std::string bytes;
+    std::vector<Event> events;
+    bytes.reserve(PENDING_RESERVE);
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return m_stop || !m_events.empty(); });
+            if (m_events.empty()) return;  // stopping, nothing left
+
+            // Take everything pending; write() keeps appending meanwhile
+            bytes.swap(m_pending);
+            events.swap(m_events);
+        }
+
+        writeEvents(events, bytes);
+        bytes.clear();
+        events.clear();
+    }
+}
+
+void CastBackend::writeEvents(const std::vector<Event>& events, const std::string& bytes) {
+    char time[32];
+    size_t begin = 0;
+
+    for (const auto& ev : events) {
+        m_line.clear();
+        std::snprintf(time, sizeof(time), "[%.6f, \"o\", ", ev.time);
+        m_line += time;
+        appendJsonString(m_line, bytes.data() + begin, ev.end - begin);
+        m_line += "]\n";
+        std::fwrite(m_line.data(), 1, m_line.size(), m_file);
+        begin = ev.end;
+    }
+    std::fflush(m_file);
+}
+
+} // namespace tui
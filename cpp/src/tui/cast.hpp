@@ -0,0 +1,62 @@
+#pragma once
+
+#include "backend.hpp"
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+namespace tui {
+
+// Passes frames on to another backend and tees them into an asciicast v2
+// file (a JSON header line, then one [time, "o", data] line per frame), so
+// sessions can be played back with standard players or decoded offline.
+// write() only copies the frame into a pending buffer; a background thread
+// escapes and writes it, so the recording never holds up a frame.
+class CastBackend : public Backend {
+public:
+    // Pending bytes above which frames are left out of the recording
+    // rather than buffered without bound
+    static constexpr size_t MAX_PENDING = 64 * 1024 * 1024;
+
+    // Throws std::runtime_error if the file cannot be created
+    CastBackend(std::unique_ptr<Backend> inner, const std::string& path);
+    ~CastBackend() override;
+
+    CastBackend(const CastBackend&) = delete;
+    CastBackend& operator=(const CastBackend&) = delete;
+
+    std::pair<int, int> size() const override { return m_inner->size(); }
+    bool synchronizedOutput() const override { return m_inner->synchronizedOutput(); }
+    bool keyReleases() const override { return m_inner->keyReleases(); }
+    bool repeatCells() const override { return m_inner->repeatCells(); }
+    bool write(OutputBuffer& frame) override;
+
+    // Frames left out because the file fell too far behind
+    u64 skippedFrames() const;
+
+private:
+    struct Event {
+        double time;  // seconds since the recording started
+        size_t end;   // end offset in the pending bytes
+    };
+
+    void run();
+    void writeEvents(const std::vector<Event>& events, const std::string& bytes);
+
+    std::unique_ptr<Backend> m_inner;
+    FILE* m_file;
+    std::chrono::steady_clock::time_point m_start;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::string m_pending;
+    std::vector<Event> m_events;
+    u64 m_skipped = 0;
+    bool m_stop = false;
+
+    std::string m_line;  // escaped output, reused by the thread
+    std::thread m_thread;
+};
+
+} // namespace tui
@@ -2,38 +2,38 @@
 
 #include "color.hpp"
 #include <cstring>
+#include <type_traits>
 
 namespace tui {
 
+// Packed 8-byte cell. Glyph and style are ids into the owning Screen's
+// GlyphTable and StyleTable, so cells compare as plain integers and rows
+// of cells can be compared as raw memory (see diff.hpp).
 struct Cell {
-    std::array<char, 5> ch = {' ', '\0', '\0', '\0', '\0'};  // UTF-8 char + null
-    Color fg = Color::None();
-    Color bg = Color::None();
+    // Never produced by drawing; marks a cell whose contents are unknown
+    static constexpr u32 INVALID_GLYPH = 0xFFFFFFFF;
+
+    u32 glyph = ' ';        // see GlyphTable
+    u16 style = 0;          // see StyleTable, 0 = default colors
     u8 attrs = ATTR_NONE;
+    u8 pad = 0;
 
     Cell() = default;
 
-    void setChar(std::string_view s) {
-        ch.fill('\0');
-        auto len = std::min(s.size(), size_t(4));
-        std::memcpy(ch.data(), s.data(), len);
-    }
-
-    void clear() {
-        ch = {' ', '\0', '\0', '\0', '\0'};
-        fg = Color::None();
-        bg = Color::None();
-        attrs = ATTR_NONE;
-    }
+    void clear() { *this = Cell(); }
 
-    bool operator==(const Cell& other) const {
-        return fg == other.fg && bg == other.bg &&
-               attrs == other.attrs && ch == other.ch;
+    u64 bits() const {
+        u64 v;
+        std::memcpy(&v, this, sizeof(v));
+        return v;
     }
 
-    bool operator!=(const Cell& other) const {
-        return !(*this == other);
-    }
+    bool operator==(const Cell& other) const { return bits() == other.bits(); }
+    bool operator!=(const Cell& other) const { return bits() != other.bits(); }
 };
 
+static_assert(sizeof(Cell) == 8, "Cell must stay 8 bytes");
+static_assert(std::has_unique_object_representations_v<Cell>,
+              "Cell must not contain implicit padding");
+
 } // namespace tui
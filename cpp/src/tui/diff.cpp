@@ -0,0 +1,164 @@
+#include "diff.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TUI_DIFF_X86 1
+#endif
+
+namespace tui {
+
+namespace {
+
+constexpr size_t CELL_SIZE = sizeof(Cell);
+
+// SIMD kernels work on bytes; a differing byte maps back to its cell.
+DiffRange byteRange(size_t firstByte, size_t lastByte) {
+    return {static_cast<int>(firstByte / CELL_SIZE),
+            static_cast<int>(lastByte / CELL_SIZE)};
+}
+
+DiffRange diffScalar(const Cell* a, const Cell* b, int count) {
+    int first = 0;
+    while (first < count && a[first] == b[first]) first++;
+    if (first == count) return {};
+
+    int last = count - 1;
+    while (a[last] == b[last]) last--;
+    return {first, last};
+}
+
+#ifdef TUI_DIFF_X86
+
+__attribute__((target("sse2")))
+unsigned neqMask16(const u8* a, const u8* b) {
+    __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+    __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+    return ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) & 0xFFFFu;
+}
+
+__attribute__((target("sse2")))
+DiffRange diffSse2(const Cell* a, const Cell* b, int count) {
+    auto* pa = reinterpret_cast<const u8*>(a);
+    auto* pb = reinterpret_cast<const u8*>(b);
+    size_t n = static_cast<size_t>(count) * CELL_SIZE;
+
+    // Forward: skip equal 64-byte blocks, then locate the byte
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m128i eq = _mm_cmpeq_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(pa + i)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(pb + i)));
+        for (size_t k = 16; k < 64; k += 16) {
+            eq = _mm_and_si128(eq, _mm_cmpeq_epi8(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(pa + i + k)),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(pb + i + k))));
+        }
+        if (_mm_movemask_epi8(eq) != 0xFFFF) break;
+    }
+
+    size_t first = n;
+    for (; i + 16 <= n; i += 16) {
+        unsigned mask = neqMask16(pa + i, pb + i);
+        if (mask) {
+            first = i + __builtin_ctz(mask);
+            break;
+        }
+    }
+    if (first == n) {
+        for (; i < n; i++) {
+            if (pa[i] != pb[i]) {
+                first = i;
+                break;
+            }
+        }
+        if (first == n) return {};
+    }
+
+    // Backward: a differing byte exists at or after first
+    size_t j = n;
+    for (; j >= first + 16; j -= 16) {
+        unsigned mask = neqMask16(pa + j - 16, pb + j - 16);
+        if (mask) return byteRange(first, j - 16 + (31 - __builtin_clz(mask)));
+    }
+    while (j > first && pa[j - 1] == pb[j - 1]) j--;
+    return byteRange(first, j > first ? j - 1 : first);
+}
+
+__attribute__((target("avx2")))
+unsigned neqMask32(const u8* a, const u8* b) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+    return ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+}
+
+__attribute__((target("avx2")))
+DiffRange diffAvx2(const Cell* a, const Cell* b, int count) {
+    auto* pa = reinterpret_cast<const u8*>(a);
+    auto* pb = reinterpret_cast<const u8*>(b);
+    size_t n = static_cast<size_t>(count) * CELL_SIZE;
+
+    // Forward: skip equal 128-byte blocks, then locate the byte
+    size_t i = 0;
+    for (; i + 128 <= n; i += 128) {
+        __m256i eq = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pa + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pb + i)));
+        for (size_t k = 32; k < 128; k += 32) {
+            eq = _mm256_and_si256(eq, _mm256_cmpeq_epi8(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pa + i + k)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pb + i + k))));
+        }
+        if (static_cast<unsigned>(_mm256_movemask_epi8(eq)) != 0xFFFFFFFFu) break;
+    }
+
+    size_t first = n;
+    for (; i + 32 <= n; i += 32) {
+        unsigned mask = neqMask32(pa + i, pb + i);
+        if (mask) {
+            first = i + __builtin_ctz(mask);
+            break;
+        }
+    }
+    if (first == n) {
+        for (; i < n; i++) {
+            if (pa[i] != pb[i]) {
+                first = i;
+                break;
+            }
+        }
+        if (first == n) return {};
+    }
+
+    // Backward: a differing byte exists at or after first
+    size_t j = n;
+    for (; j >= first + 32; j -= 32) {
+        unsigned mask = neqMask32(pa + j - 32, pb + j - 32);
+        if (mask) return byteRange(first, j - 32 + (31 - __builtin_clz(mask)));
+    }
+    while (j > first && pa[j - 1] == pb[j - 1]) j--;
+    return byteRange(first, j > first ? j - 1 : first);
+}
+
+#endif // TUI_DIFF_X86
+
+} // namespace
+
+const std::vector<DiffKernel>& diffKernels() {
+    static const std::vector<DiffKernel> kernels = [] {
+        std::vector<DiffKernel> k = {{"scalar", diffScalar}};
+#ifdef TUI_DIFF_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse2")) k.push_back({"sse2", diffSse2});
+        if (__builtin_cpu_supports("avx2")) k.push_back({"avx2", diffAvx2});
+#endif
+        return k;
+    }();
+    return kernels;
+}
+
+const DiffKernel& diffKernel() {
+    static const DiffKernel& kernel = diffKernels().back();
+    return kernel;
+}
+
+} // namespace tui
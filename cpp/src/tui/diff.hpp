@@ -0,0 +1,34 @@
+#pragma once
+
+#include "cell.hpp"
+
+namespace tui {
+
+// Inclusive range of differing cells, empty when nothing differs
+struct DiffRange {
+    int first = -1;
+    int last = -1;
+
+    bool empty() const { return first < 0; }
+};
+
+// Compares count cells of a and b and returns the first and last differing
+// column. Kernels compare raw memory, which Cell's layout allows.
+using DiffFn = DiffRange (*)(const Cell* a, const Cell* b, int count);
+
+struct DiffKernel {
+    const char* name;
+    DiffFn fn;
+};
+
+// Kernels the running CPU supports, scalar first and fastest last
+const std::vector<DiffKernel>& diffKernels();
+
+// Fastest supported kernel, selected once at startup
+const DiffKernel& diffKernel();
+
+inline DiffRange diffCells(const Cell* a, const Cell* b, int count) {
+    return diffKernel().fn(a, b, count);
+}
+
+} // namespace tui
@@ -0,0 +1,235 @@
+#include "encoder.hpp"
+
+namespace tui {
+
+namespace {
+
+int digits(int n) {
+    int d = 1;
+    while (n >= 10) {
+        n /= 10;
+        d++;
+    }
+    return d;
+}
+
+// Length of CSI n <final>, where n = 1 is the default and is omitted
+int csiLen(int n) {
+    return 3 + (n == 1 ? 0 : digits(n));
+}
+
+int cupLen(int x, int y) {
+    if (x == 0 && y == 0) return 3;
+    if (x == 0) return 3 + digits(y + 1);
+    return 4 + digits(y + 1) + digits(x + 1);
+}
+
+} // namespace
+
+void Encoder::begin(OutputBuffer& out, int width) {
+    m_out = &out;
+    m_width = width;
+    m_x = -1;
+    m_y = -1;
+    m_penSet = false;
+}
+
+void Encoder::row(int y, const Cell* back, Cell* front, int x0, int x1) {
+    int x = x0;
+    while (x <= x1) {
+        if (back[x] == front[x]) {
+            x++;
+            continue;
+        }
+
+        moveTo(x, y, back);
+        setPen(back[x]);
+
+        if (m_options.erase) {
+            int end = eraseRun(back, front, x);
+            if (end > x) {
+                x = end;
+                continue;
+            }
+        }
+
+        std::string_view glyph = m_glyphs.bytes(back[x].glyph);
+        m_out->append(glyph.data(), glyph.size());
+        front[x] = back[x];
+
+        if (m_options.repeat) {
+            x = repeatRun(back, front, x);
+        }
+
+        // Writing the last column leaves the cursor in a pending-wrap state
+        m_x = (x + 1 < m_width) ? x + 1 : -1;
+        x++;
+    }
+}
+
+int Encoder::eraseRun(const Cell* back, Cell* front, int x) {
+    // Erased cells take the current background, so only default blanks
+    // (and the default pen, set for back[x]) qualify
+    const Cell blank;
+    if (back[x] != blank) return x;
+
+    int end = x + 1;
+    while (end < m_width && back[end] == blank) end++;
+    int n = end - x;
+
+    if (end == m_width && n > 3) {
+        m_out->append("\x1b[K");
+    } else if (n > 2 * csiLen(n)) {
+        // ECH leaves the cursor in place, so count a move past the run too
+        appendCsi(n, 'X');
+    } else {
+        return x;
+    }
+
+    for (int k = x; k < end; k++) front[k] = back[k];
+    return end;
+}
+
+int Encoder::repeatRun(const Cell* back, Cell* front, int x) {
+    int end = x + 1;
+    while (end < m_width && back[end] == back[x]) end++;
+    int n = end - x - 1;
+    if (n == 0) return x;
+
+    int glyphLen = static_cast<int>(m_glyphs.bytes(back[x].glyph).size());
+    if (n * glyphLen <= csiLen(n)) return x;
+
+    appendCsi(n, 'b');
+    for (int k = x + 1; k < end; k++) front[k] = back[k];
+    return end - 1;
+}
+
+void Encoder::setPen(const Cell& cell) {
+    if (m_penSet && cell.style == m_style && cell.attrs == m_attrs) return;
+
+    u32 pen = m_sgr.pen(cell.style, cell.attrs);
+    std::string_view seq = m_penSet ? m_sgr.transition(m_pen, pen) : m_sgr.full(pen);
+    m_out->append(seq.data(), seq.size());
+
+    m_penSet = true;
+    m_pen = pen;
+    m_style = cell.style;
+    m_attrs = cell.attrs;
+}
+
+int Encoder::resendCost(int x, const Cell* back) const {
+    int cost = 0;
+    for (int k = m_x; k < x; k++) {
+        if (!m_penSet || back[k].style != m_style || back[k].attrs != m_attrs) return -1;
+        cost += static_cast<int>(m_glyphs.bytes(back[k].glyph).size());
+    }
+    return cost;
+}
+
+void Encoder::moveTo(int x, int y, const Cell* back) {
+    if (m_x == x && m_y == y) return;
+
+    int cup = cupLen(x, y);
+    if (m_x < 0 || !m_options.relativeMoves) {
+        appendCup(x, y);
+        m_x = x;
+        m_y = y;
+        return;
+    }
+
+    // Vertical part: LFs (column is kept, output processing is off) or CUD/CUU
+    int dy = y - m_y;
+    int vertical = 0;
+    bool useLf = false;
+    if (dy > 0) {
+        useLf = dy <= csiLen(dy);
+        vertical = useLf ? dy : csiLen(dy);
+    } else if (dy < 0) {
+        vertical = csiLen(-dy);
+    }
+
+    // Horizontal part, cheapest of the candidates below
+    enum class H { None, Resend, Forward, Back, Cr, CrForward, Column };
+    int dx = x - m_x;
+    H how = H::None;
+    int horizontal = 0;
+
+    if (dx != 0) {
+        auto consider = [&](H option, int cost) {
+            if (cost >= 0 && (how == H::None || cost < horizontal)) {
+                how = option;
+                horizontal = cost;
+            }
+        };
+
+        consider(H::Column, csiLen(x + 1));
+        if (x == 0) consider(H::Cr, 1);
+        else consider(H::CrForward, 1 + csiLen(x));
+        if (dx > 0) {
+            consider(H::Forward, csiLen(dx));
+            if (dy == 0 && dx <= MAX_RESEND) consider(H::Resend, resendCost(x, back));
+        } else {
+            consider(H::Back, csiLen(-dx));
+        }
+    }
+
+    if (cup <= vertical + horizontal) {
+        appendCup(x, y);
+        m_x = x;
+        m_y = y;
+        return;
+    }
+
+    if (dy > 0) {
+        if (useLf) m_out->append(static_cast<size_t>(dy), '\n');
+        else appendCsi(dy, 'B');
+    } else if (dy < 0) {
+        appendCsi(-dy, 'A');
+    }
+
+    switch (how) {
+        case H::None: break;
+        case H::Resend:
+            for (int k = m_x; k < x; k++) {
+                std::string_view glyph = m_glyphs.bytes(back[k].glyph);
+                m_out->append(glyph.data(), glyph.size());
+            }
+            break;
+        case H::Forward:   appendCsi(dx, 'C'); break;
+        case H::Back:      appendCsi(-dx, 'D'); break;
+        case H::Cr:        m_out->push_back('\r'); break;
+        case H::CrForward: m_out->push_back('\r'); appendCsi(x, 'C'); break;
+        case H::Column:    appendCsi(x + 1, 'G'); break;
+    }
+
+    m_x = x;
+    m_y = y;
+}
+
+void Encoder::appendInt(int n) {
+    char buf[12];
+    int len = 0;
+    do {
+        buf[len++] = static_cast<char>('0' + n % 10);
+        n /= 10;
+    } while (n > 0);
+    while (len > 0) m_out->push_back(buf[--len]);
+}
+
+void Encoder::appendCsi(int n, char final) {
+    m_out->append("\x1b[");
+    if (n != 1) appendInt(n);
+    m_out->push_back(final);
+}
+
+void Encoder::appendCup(int x, int y) {
+    m_out->append("\x1b[");
+    if (x != 0 || y != 0) appendInt(y + 1);
+    if (x != 0) {
+        m_out->push_back(';');
+        appendInt(x + 1);
+    }
+    m_out->push_back('H');
+}
+
+} // namespace tui
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "cell.hpp"
+#include "glyph.hpp"
+#include "sgr.hpp"
+#include "output.hpp"
+
+namespace tui {
+
+struct EncoderOptions {
+    // Pick the cheapest cursor motion (CHA, CUF/CUB, CR, LF, CUD/CUU or
+    // re-sending unchanged cells) instead of always addressing with CUP
+    bool relativeMoves = true;
+
+    // Erase runs of blank cells with ECH, or EL when they reach the end
+    // of the row
+    bool erase = true;
+
+    // Repeat runs of identical cells with REP (CSI n b). Not every
+    // terminal implements it, so it is off unless the backend reports
+    // support (Backend::repeatCells).
+    bool repeat = false;
+};
+
+// Turns changed cells into terminal output. Within a frame it tracks the
+// cursor position and the current pen so it only sends what is needed.
+class Encoder {
+public:
+    // Gaps of at most this many unchanged cells may be re-sent as-is
+    static constexpr int MAX_RESEND = 3;
+
+    Encoder(const GlyphTable& glyphs, SgrCache& sgr, EncoderOptions options = {})
+        : m_glyphs(glyphs), m_sgr(sgr), m_options(options) {}
+
+    const EncoderOptions& options() const { return m_options; }
+    void setOptions(EncoderOptions options) { m_options = options; }
+
+    // Starts a frame appended to out; cursor and pen are unknown until set
+    void begin(OutputBuffer& out, int width);
+
+    // Emits the cells of row y within columns x0..x1 that differ between
+    // back and front, and copies them to front. back and front point at
+    // the start of full rows: runs may extend past x1 over cells that are
+    // already up to date.
+    void row(int y, const Cell* back, Cell* front, int x0, int x1);
+
+private:
+    // Tries to erase the blank run starting at x; returns the column after
+    // it, or x when writing the blanks is cheaper
+    int eraseRun(const Cell* back, Cell* front, int x);
+
+    // Tries to repeat back[x], which was just written, over the identical
+    // cells after it; returns the last column written
+    int repeatRun(const Cell* back, Cell* front, int x);
+
+    void moveTo(int x, int y, const Cell* back);
+    void setPen(const Cell& cell);
+
+    // Bytes needed to re-send back[m_x..x), or -1 if they need another pen
+    int resendCost(int x, const Cell* back) const;
+
+    void appendInt(int n);
+    void appendCsi(int n, char final);
+    void appendCup(int x, int y);
+
+    const GlyphTable& m_glyphs;
+    SgrCache& m_sgr;
+    EncoderOptions m_options;
+
+    OutputBuffer* m_out = nullptr;
+    int m_width = 0;
+
+    // Cursor position, m_x < 0 when unknown (frame start, pending wrap)
+    int m_x = -1;
+    int m_y = -1;
+
+    // Current pen, valid once m_penSet
+    bool m_penSet = false;
+    u32 m_pen = 0;
+    u16 m_style = 0;
+    u8 m_attrs = 0;
+};
+
+} // namespace tui
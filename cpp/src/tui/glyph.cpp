@@ -0,0 +1,41 @@
+#include "glyph.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace tui {
+
+const std::array<char, 128> GlyphTable::ASCII = [] {
+    std::array<char, 128> table = {};
+    for (int i = 0; i < 128; i++) table[i] = static_cast<char>(i);
+    return table;
+}();
+
+u32 GlyphTable::intern(std::string_view ch) {
+    if (ch.size() == 1 && static_cast<unsigned char>(ch[0]) < FIRST_INTERNED) {
+        return static_cast<unsigned char>(ch[0]);
+    }
+
+    u32 key = 0;
+    std::memcpy(&key, ch.data(), std::min(ch.size(), size_t(4)));
+    if (key == m_lastKey) return m_lastGlyph;
+
+    auto it = m_ids.find(key);
+    u32 glyph;
+    if (it != m_ids.end()) {
+        glyph = it->second;
+    } else {
+        Entry e = {};
+        e.len = static_cast<u8>(std::min(ch.size(), size_t(4)));
+        std::memcpy(e.bytes.data(), ch.data(), e.len);
+
+        glyph = FIRST_INTERNED + static_cast<u32>(m_entries.size());
+        m_entries.push_back(e);
+        m_ids.emplace(key, glyph);
+    }
+
+    m_lastKey = key;
+    m_lastGlyph = glyph;
+    return glyph;
+}
+
+} // namespace tui
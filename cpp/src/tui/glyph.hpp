@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../common.hpp"
+#include <unordered_map>
+
+namespace tui {
+
+// Maps single UTF-8 characters to compact glyph ids. ASCII characters are
+// their own id; multi-byte characters (box drawing, etc.) are interned on
+// first use and keep their id for the lifetime of the table.
+class GlyphTable {
+public:
+    static constexpr u32 FIRST_INTERNED = 0x80;
+
+    // ch must hold exactly one UTF-8 character (1-4 bytes)
+    u32 intern(std::string_view ch);
+
+    // UTF-8 bytes of a glyph returned by intern()
+    std::string_view bytes(u32 glyph) const {
+        if (glyph < FIRST_INTERNED) {
+            return {&ASCII[glyph], 1};
+        }
+        const Entry& e = m_entries[glyph - FIRST_INTERNED];
+        return {e.bytes.data(), e.len};
+    }
+
+    size_t size() const { return m_entries.size(); }
+
+private:
+    struct Entry {
+        std::array<char, 4> bytes;
+        u8 len;
+    };
+
+    static const std::array<char, 128> ASCII;
+
+    std::vector<Entry> m_entries;
+    std::unordered_map<u32, u32> m_ids;  // packed UTF-8 bytes -> glyph
+
+    // Consecutive lookups of the same glyph (border runs) skip the map
+    u32 m_lastKey = 0;
+    u32 m_lastGlyph = ' ';
+};
+
+} // namespace tui
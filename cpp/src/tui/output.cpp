@@ -0,0 +1,105 @@
+#include "output.hpp"
+#include <unistd.h>
+#include <poll.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <algorithm>
+
+namespace tui {
+
+void OutputBuffer::clear() {
+    m_syscalls = 0;
+    m_filled = 0;
+    m_begin = m_chunks.empty() ? nullptr : m_chunks[0].get();
+    m_pos = m_begin;
+    m_end = m_begin ? m_begin + CHUNK_SIZE : nullptr;
+}
+
+void OutputBuffer::nextChunk() {
+    if (m_begin) m_filled++;
+    if (m_filled == m_chunks.size()) {
+        m_chunks.push_back(std::make_unique<char[]>(CHUNK_SIZE));
+    }
+    m_begin = m_chunks[m_filled].get();
+    m_pos = m_begin;
+    m_end = m_begin + CHUNK_SIZE;
+}
+
+void OutputBuffer::append(const char* data, size_t len) {
+    while (len > 0) {
+        if (m_pos == m_end) nextChunk();
+        size_t n = std::min(len, static_cast<size_t>(m_end - m_pos));
+        std::memcpy(m_pos, data, n);
+        m_pos += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void OutputBuffer::append(size_t count, char c) {
+    while (count > 0) {
+        if (m_pos == m_end) nextChunk();
+        size_t n = std::min(count, static_cast<size_t>(m_end - m_pos));
+        std::memset(m_pos, c, n);
+        m_pos += n;
+        count -= n;
+    }
+}
+
+bool OutputBuffer::writeTo(int fd) {
+    m_syscalls = 0;
+    m_iov.clear();
+    for (size_t i = 0; i < m_filled; i++) {
+        m_iov.push_back({m_chunks[i].get(), CHUNK_SIZE});
+    }
+    if (m_pos != m_begin) {
+        m_iov.push_back({m_begin, static_cast<size_t>(m_pos - m_begin)});
+    }
+
+    size_t i = 0;
+    while (i < m_iov.size()) {
+        int count = static_cast<int>(std::min(m_iov.size() - i, static_cast<size_t>(IOV_MAX)));
+        ssize_t n = writev(fd, &m_iov[i], count);
+        m_syscalls++;
+
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd pfd = {fd, POLLOUT, 0};
+                poll(&pfd, 1, -1);
+                continue;
+            }
+            return false;
+        }
+        if (n == 0) return false;
+
+        // Drop what was written; a short write ends inside an iovec
+        size_t left = static_cast<size_t>(n);
+        while (i < m_iov.size() && left >= m_iov[i].iov_len) {
+            left -= m_iov[i].iov_len;
+            i++;
+        }
+        if (left > 0) {
+            m_iov[i].iov_base = static_cast<char*>(m_iov[i].iov_base) + left;
+            m_iov[i].iov_len -= left;
+        }
+    }
+    return true;
+}
+
+void OutputBuffer::copyTo(std::string& out) const {
+    out.reserve(out.size() + size());
+    for (size_t i = 0; i < m_filled; i++) {
+        out.append(m_chunks[i].get(), CHUNK_SIZE);
+    }
+    if (m_begin) out.append(m_begin, static_cast<size_t>(m_pos - m_begin));
+}
+
+std::string OutputBuffer::str() const {
+    std::string out;
+    copyTo(out);
+    return out;
+}
+
+} // namespace tui
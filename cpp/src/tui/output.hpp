@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../common.hpp"
+#include <sys/uio.h>
+
+namespace tui {
+
+// Byte buffer for one frame of terminal output. Storage is a list of
+// fixed-size chunks that is kept across clear(), so once the largest frame
+// has been seen appending never allocates. The chunks are written with
+// writev(), retrying short writes and EINTR.
+class OutputBuffer {
+public:
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+    OutputBuffer() = default;
+
+    // Non-copyable: m_begin/m_pos point into the chunks
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    void clear();
+
+    size_t size() const {
+        return m_filled * CHUNK_SIZE + static_cast<size_t>(m_pos - m_begin);
+    }
+    bool empty() const { return size() == 0; }
+
+    void push_back(char c) {
+        if (m_pos == m_end) nextChunk();
+        *m_pos++ = c;
+    }
+
+    void append(const char* data, size_t len);
+    void append(std::string_view str) { append(str.data(), str.size()); }
+    void append(size_t count, char c);
+
+    OutputBuffer& operator+=(std::string_view str) {
+        append(str);
+        return *this;
+    }
+
+    // Writes the whole buffer to fd. Returns false on a write error, in
+    // which case part of the buffer may have been written.
+    bool writeTo(int fd);
+
+    // Number of write syscalls made by the last writeTo(), 0 after clear()
+    int syscalls() const { return m_syscalls; }
+
+    // Appends the contents to out
+    void copyTo(std::string& out) const;
+    std::string str() const;
+
+private:
+    void nextChunk();
+
+    std::vector<std::unique_ptr<char[]>> m_chunks;
+    size_t m_filled = 0;       // full chunks before the current one
+    char* m_begin = nullptr;   // current chunk
+    char* m_pos = nullptr;
+    char* m_end = nullptr;
+
+    std::vector<struct iovec> m_iov;  // reused by writeTo()
+    int m_syscalls = 0;
+};
+
+} // namespace tui
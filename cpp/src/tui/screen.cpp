@@ -1,18 +1,58 @@
 #include "screen.hpp"
-#include <unistd.h>
-#include <cstdio>
-#include <cstring>
+#include "diff.hpp"
+#include <algorithm>
 
 namespace tui {
 
-Screen::Screen() {
-    auto [w, h] = m_terminal.size();
+Screen::Screen() : Screen(std::make_unique<TtyBackend>()) {}
+
+Screen::Screen(std::unique_ptr<Backend> backend) : m_backend(std::move(backend)) {
+    auto [w, h] = m_backend->size();
     m_width = w;
     m_height = h;
 
     int size = m_width * m_height;
     m_back.resize(size);
     m_front.resize(size);
+    resetDamage();
+
+    EncoderOptions options;
+    options.repeat = m_backend->repeatCells();
+    setEncoderOptions(options);
+
+    m_frame = std::make_unique<Frame>();
+}
+
+void Screen::setAsyncOutput(bool enabled) {
+    if (enabled == static_cast<bool>(m_writer)) return;
+
+    if (enabled) {
+        m_writer = std::make_unique<Writer>(*m_backend);
+    } else {
+        // Keep the writer's counters once the queue is written
+        m_writer->stop();
+        m_writer->addStats(m_stats);
+        m_writer.reset();
+        if (!m_frame) m_frame = std::make_unique<Frame>();
+    }
+}
+
+FlushStats Screen::stats() const {
+    FlushStats stats = m_stats;
+    if (m_writer) m_writer->addStats(stats);
+    return stats;
+}
+
+void Screen::resetDamage() {
+    m_dirtyRows.assign((m_height + 63) / 64, 0);
+    m_dirty.assign(m_height, Span{});
+    m_ink.assign(m_height, Span{});
+}
+
+void Screen::damage(int y, int x0, int x1) {
+    m_dirtyRows[y / 64] |= u64(1) << (y % 64);
+    m_dirty[y].extend(x0, x1);
+    m_ink[y].extend(x0, x1);
 }
 
 Cell* Screen::cell(int x, int y) {
@@ -25,31 +65,56 @@ const Cell* Screen::cell(int x, int y) const {
     return &m_back[y * m_width + x];
 }
 
+Screen::CellContents Screen::contents(int x, int y) const {
+    const Cell* c = cell(x, y);
+    if (!c) return {" ", Color::None(), Color::None(), ATTR_NONE};
+
+    const Style& style = m_styles.at(c->style);
+    return {m_glyphs.bytes(c->glyph), style.fg, style.bg, c->attrs};
+}
+
+std::pair<int, int> Screen::damagedColumns(int y) const {
+    if (y < 0 || y >= m_height) return {INT_MAX, -1};
+    return {m_dirty[y].min, m_dirty[y].max};
+}
+
 void Screen::clear() {
-    for (auto& c : m_back) {
-        c.clear();
+    for (int y = 0; y < m_height; y++) {
+        Span& ink = m_ink[y];
+        if (ink.empty()) continue;
+
+        Cell* row = &m_back[y * m_width];
+        for (int x = ink.min; x <= ink.max; x++) {
+            row[x].clear();
+        }
+
+        m_dirtyRows[y / 64] |= u64(1) << (y % 64);
+        m_dirty[y].extend(ink.min, ink.max);
+        ink.reset();
     }
 }
 
 void Screen::putChar(int x, int y, std::string_view ch) {
     Cell* c = cell(x, y);
     if (!c) return;
+    damage(y, x, x);
 
-    if (ch.empty()) {
-        c->ch = {' ', '\0', '\0', '\0', '\0'};
-        return;
-    }
+    c->glyph = glyphOf(ch);
+}
+
+u32 Screen::glyphOf(std::string_view ch) {
+    if (ch.empty()) return ' ';
 
     unsigned char first = static_cast<unsigned char>(ch[0]);
+    if (first < 0x80) return first;
+
     int len = 1;
-    if ((first & 0x80) == 0) len = 1;
-    else if ((first & 0xE0) == 0xC0) len = 2;
+    if ((first & 0xE0) == 0xC0) len = 2;
     else if ((first & 0xF0) == 0xE0) len = 3;
     else if ((first & 0xF8) == 0xF0) len = 4;
 
     len = std::min(len, static_cast<int>(ch.size()));
-    c->ch.fill('\0');
-    std::memcpy(c->ch.data(), ch.data(), len);
+    return m_glyphs.intern(ch.substr(0, len));
 }
 
 void Screen::putString(int x, int y, std::string_view str) {
@@ -92,41 +157,67 @@ void Screen::putString(int x, int y, std::string_view str) {
 
 void Screen::setFgColor(int x, int y, Color color) {
     Cell* c = cell(x, y);
-    if (c) c->fg = color;
+    if (!c) return;
+    damage(y, x, x);
+    c->style = m_styles.withFg(c->style, color);
 }
 
 void Screen::setBgColor(int x, int y, Color color) {
     Cell* c = cell(x, y);
-    if (c) c->bg = color;
+    if (!c) return;
+    damage(y, x, x);
+    c->style = m_styles.withBg(c->style, color);
 }
 
 void Screen::setAttr(int x, int y, u8 attrs) {
     Cell* c = cell(x, y);
-    if (c) c->attrs = attrs;
+    if (!c) return;
+    damage(y, x, x);
+    c->attrs = attrs;
 }
 
 void Screen::fill(int x, int y, int w, int h, std::string_view ch) {
-    for (int cy = y; cy < y + h && cy < m_height; cy++) {
-        for (int cx = x; cx < x + w && cx < m_width; cx++) {
-            putChar(cx, cy, ch);
+    int x0 = std::max(x, 0);
+    int x1 = std::min(x + w, m_width) - 1;
+    if (x0 > x1) return;
+
+    u32 glyph = glyphOf(ch);
+    for (int cy = std::max(y, 0); cy < y + h && cy < m_height; cy++) {
+        damage(cy, x0, x1);
+        Cell* row = &m_back[cy * m_width];
+        for (int cx = x0; cx <= x1; cx++) {
+            row[cx].glyph = glyph;
         }
     }
 }
 
 void Screen::fillColor(int x, int y, int w, int h, Color fg, Color bg) {
-    for (int cy = y; cy < y + h && cy < m_height; cy++) {
-        for (int cx = x; cx < x + w && cx < m_width; cx++) {
-            Cell* c = cell(cx, cy);
-            if (c) {
-                if (fg.isSet()) c->fg = fg;
-                if (bg.isSet()) c->bg = bg;
+    int x0 = std::max(x, 0);
+    int x1 = std::min(x + w, m_width) - 1;
+    if (x0 > x1) return;
+
+    // Restyling maps each old style to one new style; remember the last one
+    u16 from = 0, to = 0;
+    bool mapped = false;
+
+    for (int cy = std::max(y, 0); cy < y + h && cy < m_height; cy++) {
+        damage(cy, x0, x1);
+        Cell* row = &m_back[cy * m_width];
+        for (int cx = x0; cx <= x1; cx++) {
+            if (!mapped || row[cx].style != from) {
+                from = row[cx].style;
+                const Style& old = m_styles.at(from);
+                to = m_styles.intern(fg.isSet() ? fg : old.fg,
+                                     bg.isSet() ? bg : old.bg);
+                mapped = true;
             }
+            row[cx].style = to;
         }
     }
 }
 
 void Screen::resize() {
-    auto [newW, newH] = m_terminal.size();
+    auto [newW, newH] = m_backend->size();
     if (newW == m_width && newH == m_height) return;
 
     int newSize = newW * newH;
@@ -136,109 +227,149 @@ void Screen::resize() {
     m_front.resize(newSize);
     m_width = newW;
     m_height = newH;
+    resetDamage();
+
+    // Queued frames address the old size, and the terminal is cleared
+    // before the blank front buffer is trusted
+    m_clearPending = true;
+    if (m_writer) {
+        m_writer->reclaim(m_dropped);
+        for (auto& frame : m_dropped) {
+            forgetModes(*frame);
+            m_writer->release(std::move(frame));
+            m_stats.droppedFrames++;
+        }
+        m_dropped.clear();
+    }
 }
 
 void Screen::flush() {
-    static char buf[65536];
-    int bufPos = 0;
-
-    auto appendStr = [&](const char* str) {
-        int len = std::strlen(str);
-        if (bufPos + len < static_cast<int>(sizeof(buf))) {
-            std::memcpy(buf + bufPos, str, len);
-            bufPos += len;
-        }
-    };
-
-    auto append = [&](const char* fmt, auto... args) {
-        bufPos += std::snprintf(buf + bufPos, sizeof(buf) - bufPos, fmt, args...);
-    };
+    beginFrame();
+    encodeFrame();
+    writeFrame();
+}
 
-    int lastX = -2, lastY = -2;
-    Color lastFg(0xFFFFFFFF);  // invalid initial value
-    Color lastBg(0xFFFFFFFF);
-    u8 lastAttrs = 0xFF;
-    bool firstCell = true;
+void Screen::flushFull() {
+    m_clearPending = true;
+    flush();
+}
 
-    for (int y = 0; y < m_height; y++) {
-        for (int x = 0; x < m_width; x++) {
-            Cell& back = m_back[y * m_width + x];
-            Cell& front = m_front[y * m_width + x];
+void Screen::beginFrame() {
+    if (m_writer) {
+        // The writer is behind: the frames it has not started are
+        // superseded by this one, which has to carry their changes too
+        if (m_writer->full()) dropPending();
+        m_frame = m_writer->acquire();
+    }
 
-            if (back == front) {
-                lastX = -2;
-                continue;
-            }
+    m_frame->out.clear();
+    m_frame->rows.clear();
+    m_frame->modes = false;
+    m_frame->clears = false;
+    if (m_backend->synchronizedOutput()) {
+        m_frame->out += esc::SYNC_BEGIN;
+    }
+    m_frameStart = m_frame->out.size();
 
-            if (bufPos > static_cast<int>(sizeof(buf)) - 256) {
-                write(STDOUT_FILENO, buf, bufPos);
-                bufPos = 0;
-            }
+    // After m_frameStart, so the frame is written even with no cells
+    if (m_mouseSent != m_mouseTracking) {
+        m_frame->out += m_mouseTracking ? esc::MOUSE_ON : esc::MOUSE_OFF;
+        m_frame->modes = true;
+        m_mouseSent = m_mouseTracking;
+    }
 
-            if (x != lastX + 1 || y != lastY) {
-                append("\x1b[%d;%dH", y + 1, x + 1);
-            }
+    // The frame starts by clearing the terminal, after which every cell
+    // shows a default blank: only the rest has to be written
+    if (m_clearPending) {
+        m_frame->out += esc::RESET_ATTRS;
+        m_frame->out += esc::CLEAR_SCREEN;
+        m_frame->clears = true;
+        m_clearPending = false;
 
-            if (firstCell || back.attrs != lastAttrs) {
-                bufPos += std::snprintf(buf + bufPos, sizeof(buf) - bufPos, "\x1b[0");
-                if (back.attrs & ATTR_BOLD)      appendStr(";1");
-                if (back.attrs & ATTR_DIM)       appendStr(";2");
-                if (back.attrs & ATTR_ITALIC)    appendStr(";3");
-                if (back.attrs & ATTR_UNDERLINE) appendStr(";4");
-                if (back.attrs & ATTR_BLINK)     appendStr(";5");
-                if (back.attrs & ATTR_REVERSE)   appendStr(";7");
-                if (back.attrs & ATTR_CROSSED)   appendStr(";9");
-                appendStr("m");
-                lastAttrs = back.attrs;
-                lastFg = Color(0xFFFFFFFF);
-                lastBg = Color(0xFFFFFFFF);
-            }
+        for (auto& c : m_front) {
+            c.clear();
+        }
+        for (int y = 0; y < m_height; y++) {
+            m_dirtyRows[y / 64] |= u64(1) << (y % 64);
+            m_dirty[y].extend(0, m_width - 1);
+        }
+    }
+}
 
-            if (back.fg.isSet()) {
-                if (firstCell || back.fg != lastFg) {
-                    append("\x1b[38;2;%d;%d;%dm", back.fg.r(), back.fg.g(), back.fg.b());
-                    lastFg = back.fg;
-                }
-            } else if (firstCell || lastFg.isSet()) {
-                appendStr("\x1b[39m");
-                lastFg = Color::None();
+void Screen::dropPending() {
+    m_writer->reclaim(m_dropped);
+    for (auto& frame : m_dropped) {
+        for (const FrameRow& row : frame->rows) {
+            Cell* front = &m_front[row.y * m_width];
+            for (int x = row.x0; x <= row.x1; x++) {
+                front[x].glyph = Cell::INVALID_GLYPH;
             }
+            damage(row.y, row.x0, row.x1);
+        }
+        // Cells it left blank were never damaged, only its clear made them
+        // blank on the terminal
+        if (frame->clears) m_clearPending = true;
+        forgetModes(*frame);
+        m_writer->release(std::move(frame));
+        m_stats.droppedFrames++;
+    }
+    m_dropped.clear();
+}
 
-            if (back.bg.isSet()) {
-                if (firstCell || back.bg != lastBg) {
-                    append("\x1b[48;2;%d;%d;%dm", back.bg.r(), back.bg.g(), back.bg.b());
-                    lastBg = back.bg;
-                }
-            } else if (firstCell || lastBg.isSet()) {
-                appendStr("\x1b[49m");
-                lastBg = Color::None();
-            }
+void Screen::forgetModes(const Frame& frame) {
+    // Sent again by the next frame, whatever the terminal is in now
+    if (frame.modes) m_mouseSent.reset();
+}
 
-            int chLen = std::strlen(back.ch.data());
-            if (bufPos + chLen < static_cast<int>(sizeof(buf))) {
-                std::memcpy(buf + bufPos, back.ch.data(), chLen);
-                bufPos += chLen;
-            }
+void Screen::encodeFrame() {
+    m_encoder.begin(m_frame->out, m_width);
 
-            front = back;
+    for (int y = 0; y < m_height; y++) {
+        u64 bit = u64(1) << (y % 64);
+        if (!(m_dirtyRows[y / 64] & bit)) continue;
+        m_dirtyRows[y / 64] &= ~bit;
+
+        Span span = m_dirty[y];
+        m_dirty[y].reset();
+
+        Cell* backRow = &m_back[y * m_width];
+        Cell* frontRow = &m_front[y * m_width];
+        DiffRange diff = diffCells(backRow + span.min, frontRow + span.min,
+                                   span.max - span.min + 1);
+        if (diff.empty()) continue;
+
+        int x0 = span.min + diff.first;
+        int x1 = span.min + diff.last;
+        m_encoder.row(y, backRow, frontRow, x0, x1);
+        m_frame->rows.push_back({y, x0, x1});
+    }
+}
 
-            lastX = x;
-            lastY = y;
-            firstCell = false;
-        }
+void Screen::writeFrame() {
+    OutputBuffer& out = m_frame->out;
+    if (out.size() == m_frameStart) {
+        if (m_writer) m_writer->release(std::move(m_frame));
+        return;
     }
 
-    if (bufPos > 0) {
-        write(STDOUT_FILENO, buf, bufPos);
+    // Bracket the frame so the terminal repaints once, after all of it
+    if (m_backend->synchronizedOutput()) out += esc::SYNC_END;
+
+    // Counted by the writer once written, as queued frames may be dropped
+    if (m_writer) {
+        m_writer->submit(std::move(m_frame));
+        return;
     }
-}
 
-void Screen::flushFull() {
-    for (auto& c : m_front) {
-        c.ch[0] = '\0';
+    if (!m_backend->write(out)) {
+        m_stats.writeErrors++;
     }
-    std::printf("%s", esc::CLEAR_SCREEN);
-    flush();
+    m_stats.frames++;
+    if (m_backend->synchronizedOutput()) m_stats.syncFrames++;
+    m_stats.bytes += out.size();
+    m_stats.syscalls += out.syscalls();
+    m_stats.lastBytes = out.size();
+    m_stats.lastSyscalls = out.syscalls();
 }
 
 } // namespace tui
@@ -1,14 +1,25 @@
 #pragma once
 
-#include "terminal.hpp"
 #include "cell.hpp"
+#include "glyph.hpp"
+#include "style.hpp"
+#include "sgr.hpp"
+#include "encoder.hpp"
+#include "backend.hpp"
+#include "writer.hpp"
+#include <climits>
+#include <utility>
 
 namespace tui {
 
 class Screen {
 public:
+    // Draws on the controlling terminal
     Screen();
 
+    // Draws on backend, sized from it
+    explicit Screen(std::unique_ptr<Backend> backend);
+
     int width() const { return m_width; }
     int height() const { return m_height; }
 
@@ -17,6 +28,37 @@ public:
     void flushFull();
     void resize();
 
+    // Hands frames to a writer thread instead of writing them in flush().
+    // When it falls behind, queued frames are dropped and their changes
+    // folded into the next one.
+    void setAsyncOutput(bool enabled);
+
+    FlushStats stats() const;
+
+    // Any-motion mouse reports (esc::MOUSE_ON), off by default. The mode
+    // is switched by the next frame written.
+    void setMouseTracking(bool enabled) { m_mouseTracking = enabled; }
+    bool mouseTracking() const { return m_mouseTracking; }
+
+    const EncoderOptions& encoderOptions() const { return m_encoder.options(); }
+    void setEncoderOptions(EncoderOptions options) { m_encoder.setOptions(options); }
+
+    Backend& backend() { return *m_backend; }
+
+    // Contents of a back buffer cell with its ids resolved, for tools that
+    // check what flush() sends against what was drawn
+    struct CellContents {
+        std::string_view glyph;
+        Color fg;
+        Color bg;
+        u8 attrs;
+    };
+    CellContents contents(int x, int y) const;
+
+    // Columns of row y the next flush() will compare, as {min, max};
+    // min > max when the row has no damage
+    std::pair<int, int> damagedColumns(int y) const;
+
     // Drawing primitives
     void putChar(int x, int y, std::string_view ch);
     void putString(int x, int y, std::string_view str);
@@ -27,14 +69,72 @@ public:
     void fillColor(int x, int y, int w, int h, Color fg, Color bg);
 
 private:
+    // Inclusive column range, empty when min > max; the empty state is
+    // INT_MAX..-1 so the first extend() sets both ends
+    struct Span {
+        int min = INT_MAX;
+        int max = -1;
+
+        bool empty() const { return min > max; }
+        void extend(int x0, int x1) {
+            if (x0 < min) min = x0;
+            if (x1 > max) max = x1;
+        }
+        void reset() { min = INT_MAX; max = -1; }
+    };
+
     Cell* cell(int x, int y);
     const Cell* cell(int x, int y) const;
 
+    // Glyph id for the first UTF-8 character of ch
+    u32 glyphOf(std::string_view ch);
+
+    // Record that columns x0..x1 of row y were written
+    void damage(int y, int x0, int x1);
+    void resetDamage();
+
+    // Starts m_frame, with the synchronized-update prefix when supported
+    void beginFrame();
+
+    // Damages again the cells of queued frames the writer has not started
+    void dropPending();
+
+    // Frames that were never written, as far as their mode changes go
+    void forgetModes(const Frame& frame);
+
+    // Appends the damaged cells to m_frame; writeFrame() sends it
+    void encodeFrame();
+    void writeFrame();
+
     int m_width;
     int m_height;
     std::vector<Cell> m_back;   // Write buffer
     std::vector<Cell> m_front;  // Current screen state
-    Terminal m_terminal;         // RAII terminal management
+    GlyphTable m_glyphs;        // Glyph ids used by cells
+    StyleTable m_styles;        // Style ids used by cells
+    SgrCache m_sgr{m_styles};   // Escape sequences per (style, attrs)
+    Encoder m_encoder{m_glyphs, m_sgr};
+    std::unique_ptr<Frame> m_frame;  // Frame being encoded
+    size_t m_frameStart = 0;         // its size before any cell was encoded
+    std::vector<std::unique_ptr<Frame>> m_dropped;  // reused by dropPending()
+    FlushStats m_stats;
+
+    bool m_clearPending = false;  // the next frame starts by clearing the terminal
+
+    bool m_mouseTracking = false;
+    std::optional<bool> m_mouseSent = false;  // unknown after a dropped mode change
+
+    // Damage tracking: flush() only visits m_dirty spans, clear() only
+    // blanks m_ink spans. Outside of them m_back == m_front and
+    // m_back is blank respectively.
+    std::vector<u64> m_dirtyRows;  // one bit per row with a non-empty m_dirty span
+    std::vector<Span> m_dirty;     // per row: cells that may differ from m_front
+    std::vector<Span> m_ink;       // per row: cells that may be non-blank in m_back
+    std::unique_ptr<Backend> m_backend;
+
+    // Declared after m_backend so it finishes writing before a tty
+    // backend restores the terminal
+    std::unique_ptr<Writer> m_writer;
 };
 
 } // namespace tui
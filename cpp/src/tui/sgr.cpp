@@ -0,0 +1,158 @@
+#include "sgr.hpp"
+#include <cstdio>
+
+namespace tui {
+
+namespace {
+
+// SGR parameters for switching attributes on, in the order they are emitted
+constexpr struct { u8 attr; const char* on; } ATTR_ON[] = {
+    {ATTR_BOLD, "1"}, {ATTR_DIM, "2"}, {ATTR_ITALIC, "3"}, {ATTR_UNDERLINE, "4"},
+    {ATTR_BLINK, "5"}, {ATTR_REVERSE, "7"}, {ATTR_CROSSED, "9"},
+};
+
+// Parameters of one SGR sequence, joined with ';' when finished
+class Params {
+public:
+    void add(const char* param) {
+        if (!m_seq.empty()) m_seq += ';';
+        m_seq += param;
+    }
+
+    void addColor(Color color, int setCode, int defaultCode) {
+        char buf[24];
+        if (color.isSet()) {
+            std::snprintf(buf, sizeof(buf), "%d;2;%d;%d;%d",
+                          setCode, color.r(), color.g(), color.b());
+        } else {
+            std::snprintf(buf, sizeof(buf), "%d", defaultCode);
+        }
+        add(buf);
+    }
+
+    void addAttrsOn(u8 attrs) {
+        for (const auto& a : ATTR_ON) {
+            if (attrs & a.attr) add(a.on);
+        }
+    }
+
+    std::string finish() const {
+        if (m_seq.empty()) return {};
+        return "\x1b[" + m_seq + "m";
+    }
+
+private:
+    std::string m_seq;
+};
+
+// Resets everything, then sets what differs from the defaults
+std::string encodeReset(const Style& style, u8 attrs) {
+    Params p;
+    p.add("0");
+    p.addAttrsOn(attrs);
+    if (style.fg.isSet()) p.addColor(style.fg, 38, 39);
+    if (style.bg.isSet()) p.addColor(style.bg, 48, 49);
+    return p.finish();
+}
+
+// Turns off/on only the attributes that change and keeps equal colors
+std::string encodeDelta(const Style& fromStyle, u8 from, const Style& toStyle, u8 to) {
+    Params p;
+    u8 off = from & ~to;
+    u8 on = to & ~from;
+
+    // 22 clears both bold and dim, so a kept one has to be set again
+    if (off & (ATTR_BOLD | ATTR_DIM)) {
+        p.add("22");
+        on |= to & (ATTR_BOLD | ATTR_DIM);
+    }
+    if (off & ATTR_ITALIC)    p.add("23");
+    if (off & ATTR_UNDERLINE) p.add("24");
+    if (off & ATTR_BLINK)     p.add("25");
+    if (off & ATTR_REVERSE)   p.add("27");
+    if (off & ATTR_CROSSED)   p.add("29");
+    p.addAttrsOn(on);
+
+    if (fromStyle.fg != toStyle.fg) p.addColor(toStyle.fg, 38, 39);
+    if (fromStyle.bg != toStyle.bg) p.addColor(toStyle.bg, 48, 49);
+    return p.finish();
+}
+
+} // namespace
+
+u32 SgrCache::pen(u16 style, u8 attrs) {
+    u32 key = (static_cast<u32>(style) << 8) | attrs;
+    if (key == m_lastKey) return m_lastPen;
+
+    u32 pen;
+    auto it = m_penIds.find(key);
+    if (it != m_penIds.end()) {
+        pen = it->second;
+    } else {
+        Pen p{m_styles.at(style), attrs, {}};
+        p.full = encodeReset(p.style, attrs);
+
+        pen = static_cast<u32>(m_pens.size());
+        m_pens.push_back(std::move(p));
+        m_penIds.emplace(key, pen);
+    }
+
+    m_lastKey = key;
+    m_lastPen = pen;
+    return pen;
+}
+
+std::string SgrCache::encodeTransition(const Pen& from, const Pen& to) const {
+    std::string delta = encodeDelta(from.style, from.attrs, to.style, to.attrs);
+    return delta.size() <= to.full.size() ? delta : to.full;
+}
+
+std::string_view SgrCache::transition(u32 from, u32 to) {
+    u64 key = (static_cast<u64>(from) << 32) | to;
+
+    auto it = m_slotIds.find(key);
+    if (it != m_slotIds.end()) {
+        u32 slot = it->second;
+        if (slot != m_head) {
+            unlink(slot);
+            pushFront(slot);
+        }
+        return m_slots[slot].seq;
+    }
+
+    u32 slot;
+    if (m_slots.size() < TRANSITION_CAPACITY) {
+        slot = static_cast<u32>(m_slots.size());
+        m_slots.push_back(Slot{key, {}, NONE, NONE});
+    } else {
+        slot = m_tail;
+        unlink(slot);
+        m_slotIds.erase(m_slots[slot].key);
+        m_slots[slot].key = key;
+    }
+
+    m_slots[slot].seq = encodeTransition(m_pens[from], m_pens[to]);
+    m_slotIds.emplace(key, slot);
+    pushFront(slot);
+    return m_slots[slot].seq;
+}
+
+void SgrCache::unlink(u32 slot) {
+    Slot& s = m_slots[slot];
+    if (s.prev != NONE) m_slots[s.prev].next = s.next;
+    else m_head = s.next;
+    if (s.next != NONE) m_slots[s.next].prev = s.prev;
+    else m_tail = s.prev;
+    s.prev = s.next = NONE;
+}
+
+void SgrCache::pushFront(u32 slot) {
+    Slot& s = m_slots[slot];
+    s.prev = NONE;
+    s.next = m_head;
+    if (m_head != NONE) m_slots[m_head].prev = slot;
+    m_head = slot;
+    if (m_tail == NONE) m_tail = slot;
+}
+
+} // namespace tui
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "style.hpp"
+
+namespace tui {
+
+// Interns (fg, bg, attrs) triples as pens and caches the SGR escape
+// sequences that select them, so flush() only copies ready-made bytes.
+class SgrCache {
+public:
+    static constexpr u32 TRANSITION_CAPACITY = 256;
+
+    explicit SgrCache(const StyleTable& styles) : m_styles(styles) {}
+
+    // Pen for a cell's style id and attrs
+    u32 pen(u16 style, u8 attrs);
+
+    // Selects pen regardless of the terminal's current state
+    std::string_view full(u32 pen) const { return m_pens[pen].full; }
+
+    // Switches from pen `from` to pen `to`: only the attributes and colors
+    // that change, or a full reset when that is shorter. Least recently
+    // used transitions are evicted once TRANSITION_CAPACITY is reached.
+    std::string_view transition(u32 from, u32 to);
+
+    size_t penCount() const { return m_pens.size(); }
+
+private:
+    static constexpr u32 NONE = 0xFFFFFFFF;
+
+    struct Pen {
+        Style style;
+        u8 attrs;
+        std::string full;
+    };
+
+    struct Slot {
+        u64 key;
+        std::string seq;
+        u32 prev;
+        u32 next;
+    };
+
+    std::string encodeTransition(const Pen& from, const Pen& to) const;
+
+    void unlink(u32 slot);
+    void pushFront(u32 slot);
+
+    const StyleTable& m_styles;
+
+    std::vector<Pen> m_pens;
+    std::unordered_map<u32, u32> m_penIds;  // style << 8 | attrs -> pen
+    u32 m_lastKey = NONE;
+    u32 m_lastPen = 0;
+
+    // Transition LRU: doubly linked through Slot::prev/next
+    std::vector<Slot> m_slots;
+    std::unordered_map<u64, u32> m_slotIds;  // from << 32 | to -> slot
+    u32 m_head = NONE;  // most recently used
+    u32 m_tail = NONE;  // least recently used
+};
+
+} // namespace tui
@@ -0,0 +1,35 @@
+#include "style.hpp"
+
+namespace tui {
+
+StyleTable::StyleTable() {
+    m_styles.push_back(Style{});
+    m_ids.emplace(0, DEFAULT);
+}
+
+u16 StyleTable::intern(Color fg, Color bg) {
+    // Unset colors render the same whatever their RGB bits are
+    if (!fg.isSet()) fg = Color::None();
+    if (!bg.isSet()) bg = Color::None();
+
+    u64 key = (static_cast<u64>(fg.value) << 32) | bg.value;
+    if (key == m_lastKey) return m_lastStyle;
+
+    u16 style;
+    auto it = m_ids.find(key);
+    if (it != m_ids.end()) {
+        style = it->second;
+    } else if (m_styles.size() > 0xFFFF) {
+        return DEFAULT;
+    } else {
+        style = static_cast<u16>(m_styles.size());
+        m_styles.push_back(Style{fg, bg});
+        m_ids.emplace(key, style);
+    }
+
+    m_lastKey = key;
+    m_lastStyle = style;
+    return style;
+}
+
+} // namespace tui
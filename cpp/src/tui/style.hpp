@@ -0,0 +1,38 @@
+#pragma once
+
+#include "color.hpp"
+#include <unordered_map>
+
+namespace tui {
+
+struct Style {
+    Color fg = Color::None();
+    Color bg = Color::None();
+};
+
+// Interns (fg, bg) color pairs into 16-bit style ids. Id 0 is always the
+// default (unset) pair. When all ids are taken, new pairs fall back to 0.
+class StyleTable {
+public:
+    static constexpr u16 DEFAULT = 0;
+
+    StyleTable();
+
+    u16 intern(Color fg, Color bg);
+
+    u16 withFg(u16 style, Color fg) { return intern(fg, m_styles[style].bg); }
+    u16 withBg(u16 style, Color bg) { return intern(m_styles[style].fg, bg); }
+
+    const Style& at(u16 style) const { return m_styles[style]; }
+    size_t size() const { return m_styles.size(); }
+
+private:
+    std::vector<Style> m_styles;
+    std::unordered_map<u64, u16> m_ids;
+
+    // Drawing sets the same colors on long runs of cells
+    u64 m_lastKey = 0;
+    u16 m_lastStyle = DEFAULT;
+};
+
+} // namespace tui
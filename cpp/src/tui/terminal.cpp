@@ -1,10 +1,102 @@
 #include "terminal.hpp"
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <poll.h>
 #include <cstdio>
+#include <cstring>
+#include <string>
 
 namespace tui {
 
+namespace {
+
+constexpr int REPLY_TIMEOUT_MS = 200;
+
+// Whether replies end with a primary device attributes report (CSI ? ... c)
+bool hasDa1(const std::string& replies) {
+    size_t at = replies.find("\x1b[?");
+    while (at != std::string::npos) {
+        size_t i = at + 3;
+        while (i < replies.size() && ((replies[i] >= '0' && replies[i] <= '9') || replies[i] == ';')) {
+            i++;
+        }
+        if (i < replies.size() && replies[i] == 'c') return true;
+        at = replies.find("\x1b[?", at + 1);
+    }
+    return false;
+}
+
+// Reads terminal replies until the DA1 report, which every terminal sends
+// and which comes after the answers to earlier queries, or the timeout
+std::string readReplies() {
+    std::string replies;
+    char buf[256];
+    int waited = 0;
+
+    while (!hasDa1(replies) && waited < REPLY_TIMEOUT_MS) {
+        struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+        int ready = poll(&pfd, 1, 10);
+        if (ready < 0) break;
+        if (ready == 0) {
+            waited += 10;
+            continue;
+        }
+
+        ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+        if (n <= 0) break;
+        replies.append(buf, static_cast<size_t>(n));
+    }
+    return replies;
+}
+
+// DECRPM reply for mode 2026: CSI ? 2026 ; Ps $ y, where Ps 1-3 means the
+// mode is known (set, reset or permanently set)
+bool reportsSync(const std::string& replies) {
+    size_t at = replies.find("\x1b[?2026;");
+    if (at == std::string::npos) return false;
+
+    size_t i = at + std::strlen("\x1b[?2026;");
+    if (i + 3 > replies.size()) return false;
+    char ps = replies[i];
+    return ps >= '1' && ps <= '3' && replies.compare(i + 1, 2, "$y") == 0;
+}
+
+// Kitty keyboard protocol flags reply: CSI ? flags u
+bool reportsKeyboard(const std::string& replies) {
+    size_t at = replies.find("\x1b[?");
+    while (at != std::string::npos) {
+        size_t i = at + 3;
+        while (i < replies.size() && replies[i] >= '0' && replies[i] <= '9') i++;
+        if (i < replies.size() && replies[i] == 'u') return true;
+        at = replies.find("\x1b[?", at + 1);
+    }
+    return false;
+}
+
+// Operating level of the DA1 report, CSI ? Pp ; ... c: 62 and up are
+// VT220-class terminals (xterm, VTE, kitty, foot, ...), which implement
+// REP. The Linux console answers ?6c and GNU screen ?1;2c; neither does.
+bool reportsRep(const std::string& replies) {
+    size_t at = replies.find("\x1b[?");
+    while (at != std::string::npos) {
+        size_t i = at + 3;
+        int level = 0;
+        while (i < replies.size() && replies[i] >= '0' && replies[i] <= '9') {
+            level = level * 10 + (replies[i] - '0');
+            i++;
+        }
+        size_t end = i;
+        while (end < replies.size() && ((replies[end] >= '0' && replies[end] <= '9') || replies[end] == ';')) {
+            end++;
+        }
+        if (end < replies.size() && replies[end] == 'c') return level >= 62;
+        at = replies.find("\x1b[?", at + 1);
+    }
+    return false;
+}
+
+} // namespace
+
 Terminal::Terminal() {
     // Get original terminal settings
     if (tcgetattr(STDIN_FILENO, &m_origTermios) < 0) {
@@ -15,6 +107,7 @@ Terminal::Terminal() {
     struct termios raw = m_origTermios;
     raw.c_lflag &= ~(ECHO | ICANON | ISIG);  // no echo, canonical mode, or signals
     raw.c_iflag &= ~(IXON | ICRNL);          // no flow control, no CR->NL
+    raw.c_oflag &= ~OPOST;                   // no output processing, LF stays LF
     raw.c_cc[VMIN] = 0;                       // non-blocking read
     raw.c_cc[VTIME] = 0;
 
@@ -22,21 +115,41 @@ Terminal::Terminal() {
         return;
     }
 
-    // Enter alternate screen, hide cursor, enable mouse
-    std::printf("%s%s%s%s",
+    // Enter alternate screen, hide cursor. Mouse reports stay off until a
+    // screen asks for them (Screen::setMouseTracking).
+    std::printf("%s%s%s",
                 esc::ALT_SCREEN_ON,
                 esc::CURSOR_HIDE,
-                esc::MOUSE_ON,
                 esc::CLEAR_SCREEN);
     std::fflush(stdout);
 
     m_initialized = true;
+    detectCapabilities();
+}
+
+void Terminal::detectCapabilities() {
+    // Raw mode is on, so replies arrive unechoed on stdin. Anything the
+    // user typed in the meantime is dropped along with them.
+    std::printf("%s%s%s", esc::QUERY_SYNC, esc::QUERY_KEYBOARD, esc::QUERY_DA1);
+    std::fflush(stdout);
+
+    std::string replies = readReplies();
+    m_syncOutput = reportsSync(replies);
+    m_keyReleases = reportsKeyboard(replies);
+    m_repeatCells = reportsRep(replies);
+
+    // Pushed on the terminal's flag stack, popped by the destructor
+    if (m_keyReleases) {
+        std::printf("%s", esc::KEYBOARD_PUSH);
+        std::fflush(stdout);
+    }
 }
 
 Terminal::~Terminal() {
     if (!m_initialized) return;
 
     // Restore terminal
+    if (m_keyReleases) std::printf("%s", esc::KEYBOARD_POP);
     std::printf("%s%s%s%s",
                 esc::RESET_ATTRS,
                 esc::MOUSE_OFF,
@@ -20,9 +20,27 @@ public:
 
     std::pair<int, int> size() const;
 
+    // Whether the terminal reported support for synchronized updates
+    // (DEC private mode 2026)
+    bool synchronizedOutput() const { return m_syncOutput; }
+
+    // Whether the terminal speaks the kitty keyboard protocol, which is
+    // then enabled with press, repeat and release events
+    bool keyReleases() const { return m_keyReleases; }
+
+    // Whether the terminal is expected to implement REP (CSI n b). DA1
+    // has no attribute for it; VT220-class replies (level 62 and up) are
+    // taken as support, older or missing ones are not.
+    bool repeatCells() const { return m_repeatCells; }
+
 private:
+    void detectCapabilities();
+
     struct termios m_origTermios;
     bool m_initialized = false;
+    bool m_syncOutput = false;
+    bool m_keyReleases = false;
+    bool m_repeatCells = false;
 };
 
 // ANSI escape sequences
@@ -36,6 +54,13 @@ namespace esc {
     constexpr const char* CLEAR_SCREEN   = "\x1b[2J";
     constexpr const char* RESET_ATTRS    = "\x1b[0m";
     constexpr const char* HOME           = "\x1b[H";
+    constexpr const char* SYNC_BEGIN     = "\x1b[?2026h";
+    constexpr const char* SYNC_END       = "\x1b[?2026l";
+    constexpr const char* QUERY_SYNC     = "\x1b[?2026$p";
+    constexpr const char* QUERY_DA1      = "\x1b[c";
+    constexpr const char* QUERY_KEYBOARD = "\x1b[?u";
+    constexpr const char* KEYBOARD_PUSH  = "\x1b[>3u";  // disambiguate, event types
+    constexpr const char* KEYBOARD_POP   = "\x1b[<u";
 }
 
 } // namespace tui
@@ -0,0 +1,111 @@
+#include "writer.hpp"
+
+namespace tui {
+
+Writer::Writer(Backend& backend) : m_backend(backend) {
+    // Queue, one frame being written and one being encoded
+    m_pool.reserve(CAPACITY + 2);
+    m_thread = std::thread(&Writer::run, this);
+}
+
+Writer::~Writer() {
+    stop();
+}
+
+void Writer::stop() {
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+}
+
+std::unique_ptr<Frame> Writer::acquire() {
+    std::unique_ptr<Frame> frame;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_pool.empty()) {
+            frame = std::move(m_pool.back());
+            m_pool.pop_back();
+        }
+    }
+    if (!frame) frame = std::make_unique<Frame>();
+
+    frame->out.clear();
+    frame->rows.clear();
+    return frame;
+}
+
+void Writer::submit(std::unique_ptr<Frame> frame) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue[(m_head + m_count) % CAPACITY] = std::move(frame);
+        m_count++;
+        m_stats.queueDepth = m_count;
+        m_stats.maxQueueDepth = std::max(m_stats.maxQueueDepth, m_stats.queueDepth);
+    }
+    m_cv.notify_one();
+}
+
+bool Writer::full() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_count == CAPACITY;
+}
+
+void Writer::reclaim(std::vector<std::unique_ptr<Frame>>& dropped) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while (m_count > 0) {
+        dropped.push_back(std::move(m_queue[m_head]));
+        m_head = (m_head + 1) % CAPACITY;
+        m_count--;
+    }
+    m_stats.queueDepth = 0;
+}
+
+void Writer::release(std::unique_ptr<Frame> frame) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pool.push_back(std::move(frame));
+}
+
+void Writer::addStats(FlushStats& stats) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats.frames += m_stats.frames;
+    stats.syncFrames += m_stats.syncFrames;
+    stats.bytes += m_stats.bytes;
+    stats.syscalls += m_stats.syscalls;
+    stats.writeErrors += m_stats.writeErrors;
+    stats.lastBytes = m_stats.lastBytes;
+    stats.lastSyscalls = m_stats.lastSyscalls;
+    stats.queueDepth = m_stats.queueDepth;
+    stats.maxQueueDepth = m_stats.maxQueueDepth;
+}
+
+void Writer::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_cv.wait(lock, [this] { return m_stop || m_count > 0; });
+        if (m_count == 0) break;  // stopping, and everything is written
+
+        std::unique_ptr<Frame> frame = std::move(m_queue[m_head]);
+        m_head = (m_head + 1) % CAPACITY;
+        m_count--;
+        m_stats.queueDepth = m_count;
+
+        lock.unlock();
+        bool ok = m_backend.write(frame->out);
+        lock.lock();
+
+        if (!ok) m_stats.writeErrors++;
+        m_stats.frames++;
+        if (m_backend.synchronizedOutput()) m_stats.syncFrames++;
+        m_stats.bytes += frame->out.size();
+        m_stats.syscalls += frame->out.syscalls();
+        m_stats.lastBytes = frame->out.size();
+        m_stats.lastSyscalls = frame->out.syscalls();
+        m_pool.push_back(std::move(frame));
+    }
+}
+
+} // namespace tui
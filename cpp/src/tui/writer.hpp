@@ -0,0 +1,92 @@
+#pragma once
+
+#include "backend.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace tui {
+
+// Output counters since the Screen was created
+struct FlushStats {
+    u64 frames = 0;         // flushes that produced output and were written
+    u64 syncFrames = 0;     // frames wrapped in a synchronized update
+    u64 droppedFrames = 0;  // frames superseded before they were written
+    u64 bytes = 0;
+    u64 syscalls = 0;       // write calls, more than frames on short writes
+    u64 writeErrors = 0;
+
+    // The most recent frame written
+    u64 lastBytes = 0;
+    u64 lastSyscalls = 0;
+
+    // Frames waiting for the writer thread
+    u64 queueDepth = 0;
+    u64 maxQueueDepth = 0;
+};
+
+// Columns x0..x1 of row y, as encoded into a frame
+struct FrameRow {
+    int y, x0, x1;
+};
+
+// One encoded frame. The rows it covers let a frame that is dropped
+// before being written be damaged again in the next one.
+struct Frame {
+    OutputBuffer out;
+    std::vector<FrameRow> rows;
+    bool modes = false;   // also switches mouse tracking
+    bool clears = false;  // starts by clearing the terminal
+};
+
+// Writes frames to a backend on a background thread, so a slow terminal
+// does not block the caller. At most CAPACITY frames wait in the queue; frame
+// buffers are recycled through a pool.
+class Writer {
+public:
+    static constexpr size_t CAPACITY = 2;
+
+    explicit Writer(Backend& backend);
+    ~Writer();
+
+    // Writes the remaining frames and ends the thread
+    void stop();
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    // An empty frame, reused from the pool when possible
+    std::unique_ptr<Frame> acquire();
+
+    // Queues frame for writing; the queue must not be full
+    void submit(std::unique_ptr<Frame> frame);
+
+    bool full() const;
+
+    // Moves the frames not yet being written into dropped, oldest first
+    void reclaim(std::vector<std::unique_ptr<Frame>>& dropped);
+
+    // Returns a frame that will not be written to the pool
+    void release(std::unique_ptr<Frame> frame);
+
+    // Adds the frame and write counters and the queue gauges to stats
+    void addStats(FlushStats& stats) const;
+
+private:
+    void run();
+
+    Backend& m_backend;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+
+    std::array<std::unique_ptr<Frame>, CAPACITY> m_queue;  // ring buffer
+    size_t m_head = 0;
+    size_t m_count = 0;
+    std::vector<std::unique_ptr<Frame>> m_pool;
+
+    FlushStats m_stats;  // frame and write counters, queue gauges
+    std::thread m_thread;
+};
+
+} // namespace tui
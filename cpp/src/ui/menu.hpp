@@ -31,6 +31,7 @@ public:
     void draw(tui::Screen& screen);
 
     int currentIndex() const { return m_at; }
+    void setCurrentIndex(int at) { m_at = at; }
 
 private:
     std::vector<MenuEntry> m_entries;